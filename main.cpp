@@ -1,11 +1,45 @@
 #include <casacore/tables/Tables.h>
+#include <casacore/tables/DataMan.h>
+#include <casacore/tables/TaQL.h>
+#include <casacore/casa/Utilities/ValType.h>
+#include <casacore/casa/OS/Conversion.h>
 #include <casacore/casa/OS/Directory.h>
 #include <casacore/casa/OS/Timer.h>
 #include <casacore/casa/Arrays/ArrayError.h>
+#include <casacore/casa/HDF5/HDF5Object.h>
+
+#include "stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace casacore;
 
 #define N_ITERS 100
+#define N_REPS 1
+#define FLAG_DENSITY 0.125
+#define CADENCE 0.5
+#define N_READS 1000
+#define AVERAGE_TIMES 2
+#define AVERAGE_CHANNELS 4
+#define IO_RATE 100
+#define IO_FILE_BYTES (256LL * 1024 * 1024)
+#define CPU_BUFFER_BYTES (64LL * 1024 * 1024)
 #define N_TIMES 12
 #define N_ANTS 128
 #define N_BLS (N_ANTS * (N_ANTS + 1) / 2)
@@ -25,6 +59,100 @@ using namespace casacore;
     X(CELLS), \
     X(COLUMN)
 
+#define BENCH_MODES \
+    X(WRITE), \
+    X(READ), \
+    X(GROUP), \
+    X(QUERY), \
+    X(BASELINE), \
+    X(COPY), \
+    X(INGEST), \
+    X(RANDOM), \
+    X(SLICE), \
+    X(REDUCE), \
+    X(APPLYCAL)
+
+// TIME: row = time * nBls + baseline, the order the correlator delivers
+// BASELINE: row = baseline * nTimes + time
+#define ROW_ORDERS \
+    X(TIME), \
+    X(BASELINE)
+
+// columns that can be added to the table type's columns with -c
+#define EXTRA_COLUMNS \
+    X(FLAG), \
+    X(WEIGHT_SPECTRUM), \
+    X(ANTENNA1)
+
+// virtual column engine storing DATA (or WEIGHT_SPECTRUM) as scaled integers,
+// see bind_engine
+#define ENGINE_TYPES \
+    X(NONE), \
+    X(COMPRESS), \
+    X(COMPRESSSD), \
+    X(SCALED), \
+    X(SCALEDARRAY)
+
+// which elements of the FLAG column are flagged, see flag_value
+#define FLAG_PATTERNS \
+    X(RANDOM), \
+    X(CHANNELS), \
+    X(BASELINES)
+
+// background I/O competing for the table's filesystem, see Interference
+#define IO_LOADS \
+    X(NONE), \
+    X(SEQUENTIAL), \
+    X(RANDOM)
+
+// background kernels competing for the CPUs, see Interference
+#define CPU_LOADS \
+    X(NONE), \
+    X(COMPUTE), \
+    X(MEMORY)
+
+// element type of the DATA column
+#define DATA_ELEMENTS \
+    X(COMPLEX), \
+    X(DCOMPLEX)
+
+// storage manager for the array columns, see bind_columns
+#define STMAN_TYPES \
+    X(STANDARD), \
+    X(INCREMENTAL), \
+    X(TILEDCOLUMN), \
+    X(TILEDSHAPE), \
+    X(TILEDCELL)
+
+// names match TableLock::LockOption, see tableLockOptions
+#define LOCK_MODES \
+    X(DEFAULT), \
+    X(AUTO), \
+    X(PERMANENT), \
+    X(USER), \
+    X(NO)
+
+// names match StorageOption::Option, see storageOptions
+#define STORAGE_MODES \
+    X(DEFAULT), \
+    X(SEPFILE), \
+    X(MULTIFILE), \
+    X(MULTIHDF5)
+
+// names match TSMOption::Option, see tsmOptions
+#define TSM_MODES \
+    X(DEFAULT), \
+    X(CACHE), \
+    X(BUFFER), \
+    X(MMAP)
+
+// names match Table::EndianFormat, see endianFormats
+#define ENDIAN_MODES \
+    X(DEFAULT), \
+    X(BIG), \
+    X(LITTLE), \
+    X(LOCAL)
+
 // make an enum of table types
 #define X(name) name
 typedef enum TableType {
@@ -38,8 +166,115 @@ typedef enum WriteMode {
 } WriteMode;
 #define NUM_WRITEMODES (sizeof(writeModeNames) / sizeof(writeModeNames[0]))
 #define DEFAULT_WRITEMODE CELL
+
+typedef enum BenchMode {
+    BENCH_MODES
+} BenchMode;
+#define NUM_BENCHMODES (sizeof(benchModeNames) / sizeof(benchModeNames[0]))
+#define DEFAULT_BENCHMODE WRITE
+#undef X
+
+// row orders are prefixed to avoid clashing with the table types and bench modes
+#define X(name) ORDER_##name
+typedef enum RowOrder {
+    ROW_ORDERS
+} RowOrder;
+#define NUM_ROWORDERS (sizeof(rowOrderNames) / sizeof(rowOrderNames[0]))
+#define DEFAULT_ROWORDER ORDER_TIME
+#undef X
+
+// column and element names are prefixed to avoid clashing with the table types
+#define X(name) COL_##name
+typedef enum ExtraColumn {
+    EXTRA_COLUMNS
+} ExtraColumn;
+#define NUM_EXTRACOLUMNS (sizeof(extraColumnNames) / sizeof(extraColumnNames[0]))
+#undef X
+
+#define X(name) ENGINE_##name
+typedef enum EngineType {
+    ENGINE_TYPES
+} EngineType;
+#define NUM_ENGINETYPES (sizeof(engineTypeNames) / sizeof(engineTypeNames[0]))
+#define DEFAULT_ENGINETYPE ENGINE_NONE
+#undef X
+
+#define X(name) FLAGS_##name
+typedef enum FlagPattern {
+    FLAG_PATTERNS
+} FlagPattern;
+#define NUM_FLAGPATTERNS (sizeof(flagPatternNames) / sizeof(flagPatternNames[0]))
+#define DEFAULT_FLAGPATTERN FLAGS_RANDOM
+#undef X
+
+#define X(name) IOLOAD_##name
+typedef enum IOLoad {
+    IO_LOADS
+} IOLoad;
+#define NUM_IOLOADS (sizeof(ioLoadNames) / sizeof(ioLoadNames[0]))
+#define DEFAULT_IOLOAD IOLOAD_NONE
+#undef X
+
+#define X(name) CPULOAD_##name
+typedef enum CPULoad {
+    CPU_LOADS
+} CPULoad;
+#define NUM_CPULOADS (sizeof(cpuLoadNames) / sizeof(cpuLoadNames[0]))
+#define DEFAULT_CPULOAD CPULOAD_NONE
+#undef X
+
+#define X(name) ELEMENT_##name
+typedef enum DataElement {
+    DATA_ELEMENTS
+} DataElement;
+#define NUM_DATAELEMENTS (sizeof(dataElementNames) / sizeof(dataElementNames[0]))
+#define DEFAULT_DATAELEMENT ELEMENT_COMPLEX
 #undef X
 
+// the casacore option enums are prefixed to avoid clashing with each other
+#define X(name) LOCK_##name
+typedef enum LockMode {
+    LOCK_MODES
+} LockMode;
+#define NUM_LOCKMODES (sizeof(lockModeNames) / sizeof(lockModeNames[0]))
+#define DEFAULT_LOCKMODE LOCK_DEFAULT
+#undef X
+
+#define X(name) STORAGE_##name
+typedef enum StorageMode {
+    STORAGE_MODES
+} StorageMode;
+#define NUM_STORAGEMODES (sizeof(storageModeNames) / sizeof(storageModeNames[0]))
+#define DEFAULT_STORAGEMODE STORAGE_DEFAULT
+#undef X
+
+#define X(name) STMAN_##name
+typedef enum StManType {
+    STMAN_TYPES
+} StManType;
+#define NUM_STMANTYPES (sizeof(stManTypeNames) / sizeof(stManTypeNames[0]))
+#define DEFAULT_STMANTYPE STMAN_STANDARD
+#undef X
+
+#define X(name) TSM_##name
+typedef enum TSMMode {
+    TSM_MODES
+} TSMMode;
+#define NUM_TSMMODES (sizeof(tsmModeNames) / sizeof(tsmModeNames[0]))
+#define DEFAULT_TSMMODE TSM_DEFAULT
+#undef X
+
+#define X(name) ENDIAN_##name
+typedef enum EndianMode {
+    ENDIAN_MODES
+} EndianMode;
+#define NUM_ENDIANMODES (sizeof(endianModeNames) / sizeof(endianModeNames[0]))
+#define DEFAULT_ENDIANMODE ENDIAN_DEFAULT
+#undef X
+
+// aim for tiles of about this many bytes when the tile rows are not given
+#define TILE_BYTES (1024 * 1024)
+
 #define X(name) #name
 char const *tableTypeNames[] = {
     TABLE_TYPES
@@ -47,59 +282,284 @@ char const *tableTypeNames[] = {
 char const *writeModeNames[] = {
     WRITE_MODES
 };
+char const *benchModeNames[] = {
+    BENCH_MODES
+};
+char const *rowOrderNames[] = {
+    ROW_ORDERS
+};
+char const *extraColumnNames[] = {
+    EXTRA_COLUMNS
+};
+char const *engineTypeNames[] = {
+    ENGINE_TYPES
+};
+char const *flagPatternNames[] = {
+    FLAG_PATTERNS
+};
+char const *ioLoadNames[] = {
+    IO_LOADS
+};
+char const *cpuLoadNames[] = {
+    CPU_LOADS
+};
+char const *dataElementNames[] = {
+    DATA_ELEMENTS
+};
+char const *lockModeNames[] = {
+    LOCK_MODES
+};
+char const *storageModeNames[] = {
+    STORAGE_MODES
+};
+char const *stManTypeNames[] = {
+    STMAN_TYPES
+};
+char const *tsmModeNames[] = {
+    TSM_MODES
+};
+char const *endianModeNames[] = {
+    ENDIAN_MODES
+};
 #undef X
 
-TableType tableTypeFromName(std::string& name) {
+// casacore lock option for each LockMode
+const TableLock::LockOption tableLockOptions[] = {
+    TableLock::DefaultLocking,
+    TableLock::AutoLocking,
+    TableLock::PermanentLocking,
+    TableLock::UserLocking,
+    TableLock::NoLocking
+};
+
+// casacore storage option for each StorageMode
+const StorageOption::Option storageOptions[] = {
+    StorageOption::Aipsrc,
+    StorageOption::SepFile,
+    StorageOption::MultiFile,
+    StorageOption::MultiHDF5
+};
+
+// casacore tiled storage manager option for each TSMMode
+const TSMOption::Option tsmOptions[] = {
+    TSMOption::Aipsrc,
+    TSMOption::Cache,
+    TSMOption::Buffer,
+    TSMOption::MMap
+};
+
+// casacore endian format for each EndianMode
+const Table::EndianFormat endianFormats[] = {
+    Table::AipsrcEndian,
+    Table::BigEndian,
+    Table::LittleEndian,
+    Table::LocalEndian
+};
+
+// find the index of name (case insensitive) in a list of option names
+unsigned int indexFromName(std::string& name, char const *names[], unsigned int count, char const *what) {
     for (auto & c: name) c = toupper(c);
-    for (unsigned int i = 0; i < NUM_TABLETYPES; i++) {
-        if (name == tableTypeNames[i]) {
-            return (TableType) i;
+    for (unsigned int i = 0; i < count; i++) {
+        if (name == names[i]) {
+            return i;
         }
     }
-    throw std::runtime_error("unknown table type: " + name);
+    throw std::runtime_error("unknown " + std::string(what) + ": " + name);
+}
+
+TableType tableTypeFromName(std::string& name) {
+    return (TableType) indexFromName(name, tableTypeNames, NUM_TABLETYPES, "table type");
 }
 
 WriteMode writeModeFromName(std::string& name) {
-    for (auto & c: name) c = toupper(c);
-    for (unsigned int i = 0; i < NUM_WRITEMODES; i++) {
-        if (name == writeModeNames[i]) {
-            return (WriteMode) i;
+    return (WriteMode) indexFromName(name, writeModeNames, NUM_WRITEMODES, "write mode");
+}
+
+LockMode lockModeFromName(std::string& name) {
+    return (LockMode) indexFromName(name, lockModeNames, NUM_LOCKMODES, "lock mode");
+}
+
+StorageMode storageModeFromName(std::string& name) {
+    return (StorageMode) indexFromName(name, storageModeNames, NUM_STORAGEMODES, "storage option");
+}
+
+BenchMode benchModeFromName(std::string& name) {
+    return (BenchMode) indexFromName(name, benchModeNames, NUM_BENCHMODES, "bench mode");
+}
+
+RowOrder rowOrderFromName(std::string& name) {
+    return (RowOrder) indexFromName(name, rowOrderNames, NUM_ROWORDERS, "row order");
+}
+
+ExtraColumn extraColumnFromName(std::string& name) {
+    return (ExtraColumn) indexFromName(name, extraColumnNames, NUM_EXTRACOLUMNS, "column");
+}
+
+EngineType engineTypeFromName(std::string& name) {
+    return (EngineType) indexFromName(name, engineTypeNames, NUM_ENGINETYPES, "virtual column engine");
+}
+
+FlagPattern flagPatternFromName(std::string& name) {
+    return (FlagPattern) indexFromName(name, flagPatternNames, NUM_FLAGPATTERNS, "flag pattern");
+}
+
+IOLoad ioLoadFromName(std::string& name) {
+    return (IOLoad) indexFromName(name, ioLoadNames, NUM_IOLOADS, "I/O load");
+}
+
+CPULoad cpuLoadFromName(std::string& name) {
+    return (CPULoad) indexFromName(name, cpuLoadNames, NUM_CPULOADS, "CPU load");
+}
+
+DataElement dataElementFromName(std::string& name) {
+    return (DataElement) indexFromName(name, dataElementNames, NUM_DATAELEMENTS, "data element type");
+}
+
+StManType stManTypeFromName(std::string& name) {
+    return (StManType) indexFromName(name, stManTypeNames, NUM_STMANTYPES, "storage manager");
+}
+
+TSMMode tsmModeFromName(std::string& name) {
+    return (TSMMode) indexFromName(name, tsmModeNames, NUM_TSMMODES, "tsm option");
+}
+
+EndianMode endianModeFromName(std::string& name) {
+    return (EndianMode) indexFromName(name, endianModeNames, NUM_ENDIANMODES, "endian format");
+}
+
+// print a comma separated list of option names
+void printNames(char const *names[], unsigned int count) {
+    for (unsigned int i = 0; i < count; i++) {
+        std::cout << names[i];
+        if (i < count-1) {
+            std::cout << ", ";
         }
     }
-    throw std::runtime_error("unknown write mode: " + name);
 }
 
 void usage(char const *argv[]) {
-    std::cout << "Usage: " << argv[0] << " [-h] [-v|-q] [-V] [-s] [-i <iterations>] [-t <tabletype>] [-w <writemode>]" \
-        << " [-T <times>] [-B <baselines>] [-C <chans>] [-P <pols>]\n" \
+    std::cout << "Usage: " << argv[0] << " [-h] [-v|-q] [-V] [-s] [-g] [-i <iterations>] [-t <tabletype>] [-w <writemode>]" \
+        << " [-T <times>] [-B <baselines>] [-C <chans>] [-P <pols>] [-L <lockmode> [-l]]" \
+        << " [-O <storageoption>] [-b <blocksize>] [-m <benchmode>] [-d <stman>] [-R <tilerows>] [-M <tsmoption>]" \
+        << " [-E <endian>] [-Q <queryfile>] [-o <roworder>] [--replay <ms> [--replay-all]]" \
+        << " [--input <table>] [--cadence <seconds>] [--reads <n> [--read-channels <n>] [--seed <n>]] [--channels <range>] [--pols <range>] [--average <times:channels> [--overlap]] [--add-column] [-W <warmup>] [-r <repetitions>] [--results <file>] [-c <column>] [-e <element>]" \
+        << " [-F <density>] [-p <pattern>] [-x <engine>] [-I <ioload> [--io-rate <MiB/s>]] [-K <cpuload> [-k <threads>]]\n" \
         << "  -h: print this help message\n" \
         << "  -v: increase verbosity\n" \
         << "  -q: decrease verbosity\n" \
         << "  -V: validate the table values\n" \
         << "  -s: stream junk to the table instead of slicing a pre-allocated array\n"
+        << "  -g: generate each timestep's values when needed instead of synthesizing all rows up front\n" \
         << "  -i <iterations>: number of iterations (default: " << N_ITERS << " )\n" \
         << "  -t <tabletype>: table type (default: " << tableTypeNames[DEFAULT_TABLETYPE] << ")\n" \
         << "    options: ";
-        for (unsigned int i = 0; i < NUM_TABLETYPES; i++) {
-            std::cout << tableTypeNames[i];
-            if (i < NUM_TABLETYPES-1) {
-                std::cout << ", ";
-            }
-        }
+        printNames(tableTypeNames, NUM_TABLETYPES);
         std::cout << "\n" \
         << "  -w <writemode>: write mode (default: " << writeModeNames[DEFAULT_WRITEMODE] << ")\n" \
         << "    options: ";
-        for (unsigned int i = 0; i < NUM_WRITEMODES; i++) {
-            std::cout << writeModeNames[i];
-            if (i < NUM_WRITEMODES-1) {
-                std::cout << ", ";
-            }
-        }
+        printNames(writeModeNames, NUM_WRITEMODES);
         std::cout << "\n" \
         << "  -T <times>: number of times (default: " << N_TIMES << ")\n" \
         << "  -B <baselines>: number of baselines (default: " << N_BLS << ")\n" \
         << "  -C <chans>: number of channels (default: " << N_CHANS << ")\n" \
-        << "  -P <pols>: number of polarizations (default: " << N_POLS << ")\n";
+        << "  -P <pols>: number of polarizations (default: " << N_POLS << ")\n" \
+        << "  -L <lockmode>: table lock option (default: " << lockModeNames[DEFAULT_LOCKMODE] << ")\n" \
+        << "    options: ";
+        printNames(lockModeNames, NUM_LOCKMODES);
+        std::cout << "\n" \
+        << "  -l: with -L USER, lock and unlock once per timestep instead of once per iteration\n" \
+        << "  -O <storageoption>: table storage option (default: " << storageModeNames[DEFAULT_STORAGEMODE] << ")\n" \
+        << "    options: ";
+        printNames(storageModeNames, NUM_STORAGEMODES);
+        std::cout << "\n" \
+        << "  -b <blocksize>: MULTIFILE/MULTIHDF5 container block size in bytes (default: 0, casacore default)\n" \
+        << "  -m <benchmode>: benchmark mode (default: " << benchModeNames[DEFAULT_BENCHMODE] << ")\n" \
+        << "    options: ";
+        printNames(benchModeNames, NUM_BENCHMODES);
+        std::cout << "\n" \
+        << "  -d <stman>: storage manager for the array columns (default: " << stManTypeNames[DEFAULT_STMANTYPE] << ")\n" \
+        << "    options: ";
+        printNames(stManTypeNames, NUM_STMANTYPES);
+        std::cout << "\n" \
+        << "  -R <tilerows>: rows per tile for TILEDCOLUMN and TILEDSHAPE (default: 0, tiles of about " << TILE_BYTES << " bytes)\n" \
+        << "  -M <tsmoption>: tiled storage manager I/O option (default: " << tsmModeNames[DEFAULT_TSMMODE] << ")\n" \
+        << "    options: ";
+        printNames(tsmModeNames, NUM_TSMMODES);
+        std::cout << "\n" \
+        << "  -E <endian>: endian format of the table (default: " << endianModeNames[DEFAULT_ENDIANMODE] << ")\n" \
+        << "    options: ";
+        printNames(endianModeNames, NUM_ENDIANMODES);
+        std::cout << "\n" \
+        << "  -Q <queryfile>: TaQL statements for QUERY mode, one per line, $1 is the table (default: built in list)\n" \
+        << "  -o <roworder>: order of the rows in the table (default: " << rowOrderNames[DEFAULT_ROWORDER] << ")\n" \
+        << "    options: ";
+        printNames(rowOrderNames, NUM_ROWORDERS);
+        std::cout << "\n" \
+        << "  --replay <ms>: instead of synthetic data, replay TIME, UVW and DATA from an existing MS one timestep\n" \
+        << "    at a time into a new table, with the storage options and write mode\n" \
+        << "  --replay-all: replay every column of the MS\n" \
+        << "  --input <table>: in COPY mode, copy an existing table instead of the synthetic one\n" \
+        << "  --cadence <seconds>: in INGEST mode, the interval at which timesteps are released (default: " << CADENCE << ")\n" \
+        << "  --reads <n>: in RANDOM mode, the number of rows read from each column (default: " << N_READS << ")\n" \
+        << "  --read-channels <n>: in RANDOM mode, read a random window of n channels of each row (default: whole cells)\n" \
+        << "  --seed <n>: in RANDOM mode, the seed of the random rows (default: 1)\n" \
+        << "  --channels <start:width[:stride]>: in SLICE mode, the channels to read (default: all)\n" \
+        << "  --pols <start:width[:stride]>: in SLICE mode, the polarisations to read, e.g. 0:2:3 for XX and YY (default: all)\n" \
+        << "  --average <times:channels>: in REDUCE mode, the timesteps and channels to average (default: " \
+        << AVERAGE_TIMES << ":" << AVERAGE_CHANNELS << ")\n" \
+        << "  --overlap: in REDUCE mode, average each chunk while writing the previous one and reading the next\n" \
+        << "  --add-column: in APPLYCAL mode, add CORRECTED_DATA with Table::addColumn after the fill\n" \
+        << "  -W <warmup>: in WRITE and READ mode, untimed iterations before the timed ones (default: 0)\n" \
+        << "  -r <repetitions>: in WRITE and READ mode, independent repetitions of the timed iterations, summarized with outliers\n" \
+        << "    rejected (default: " << N_REPS << ")\n" \
+        << "  --results <file>: write the rate, real, user and system time of each repetition to a file,\n" \
+        << "    for ./runner -c\n" \
+        << "  -c <column>: add a column to the table type's columns, can be repeated\n" \
+        << "    options: ";
+        printNames(extraColumnNames, NUM_EXTRACOLUMNS);
+        std::cout << "\n" \
+        << "  -e <element>: element type of the DATA column (default: " << dataElementNames[DEFAULT_DATAELEMENT] << ")\n" \
+        << "    options: ";
+        printNames(dataElementNames, NUM_DATAELEMENTS);
+        std::cout << "\n" \
+        << "  -F <density>: fraction of the FLAG column that is flagged, from 0 to 1 (default: " << FLAG_DENSITY << ")\n" \
+        << "  -p <pattern>: which elements of the FLAG column are flagged (default: " << flagPatternNames[DEFAULT_FLAGPATTERN] << ")\n" \
+        << "    options: ";
+        printNames(flagPatternNames, NUM_FLAGPATTERNS);
+        std::cout << "\n" \
+        << "  -x <engine>: store DATA (WEIGHT_SPECTRUM for SCALEDARRAY) as scaled integers through a virtual column\n" \
+        << "    engine on top of the storage manager (default: " << engineTypeNames[DEFAULT_ENGINETYPE] << ")\n" \
+        << "    options: ";
+        printNames(engineTypeNames, NUM_ENGINETYPES);
+        std::cout << "\n" \
+        << "  -I <ioload>: background I/O on the table's filesystem while benchmarking (default: " << ioLoadNames[DEFAULT_IOLOAD] << ")\n" \
+        << "    options: ";
+        printNames(ioLoadNames, NUM_IOLOADS);
+        std::cout << "\n" \
+        << "  --io-rate <MiB/s>: rate of the background I/O, 0 for as fast as possible (default: " << IO_RATE << ")\n" \
+        << "  -K <cpuload>: background kernels on the CPUs while benchmarking (default: " << cpuLoadNames[DEFAULT_CPULOAD] << ")\n" \
+        << "    options: ";
+        printNames(cpuLoadNames, NUM_CPULOADS);
+        std::cout << "\n" \
+        << "  -k <threads>: threads running the background kernels (default: 1)\n";
+}
+
+// a strided range of indices along one axis of a cell, width 0 is up to the end
+struct Range {
+    int start = 0;
+    int width = 0;
+    int stride = 1;
+};
+
+// parse start:width[:stride]
+Range parse_range(const std::string& text) {
+    Range range;
+    char extra;
+    int n = sscanf(text.c_str(), "%d:%d:%d%c", &range.start, &range.width, &range.stride, &extra);
+    if (n < 2 || n > 3 || range.start < 0 || range.width < 0 || range.stride < 1) {
+        throw std::runtime_error("bad range, expected start:width[:stride]: " + text);
+    }
+    return range;
 }
 
 typedef struct Args {
@@ -111,398 +571,2380 @@ typedef struct Args {
     int verbosity = 0;
     WriteMode writeMode = DEFAULT_WRITEMODE;
     TableType tableType = DEFAULT_TABLETYPE;
+    LockMode lockMode = DEFAULT_LOCKMODE;
+    bool lockPerTimestep = false;
+    StorageMode storageMode = DEFAULT_STORAGEMODE;
+    int blockSize = 0;
+    BenchMode benchMode = DEFAULT_BENCHMODE;
+    StManType stManType = DEFAULT_STMANTYPE;
+    int tileRows = 0;
+    TSMMode tsmMode = DEFAULT_TSMMODE;
+    EndianMode endianMode = DEFAULT_ENDIANMODE;
+    RowOrder rowOrder = DEFAULT_ROWORDER;
     bool validate = false;
     bool stream = false;
+    bool generate = false;
+    std::string queryFile;
+    std::string replayName;
+    bool replayAll = false;
+    std::string inputName;
+    int nWarmup = 0;
+    int nReps = N_REPS;
+    std::string resultsName;
+    std::vector<ExtraColumn> extraColumns;
+    DataElement dataElement = DEFAULT_DATAELEMENT;
+    double flagDensity = FLAG_DENSITY;
+    FlagPattern flagPattern = DEFAULT_FLAGPATTERN;
+    EngineType engineType = DEFAULT_ENGINETYPE;
+    double cadence = CADENCE;
+    int nReads = N_READS;
+    int readChannels = 0;
+    unsigned long seed = 1;
+    Range channels;
+    Range pols;
+    int averageTimes = AVERAGE_TIMES;
+    int averageChannels = AVERAGE_CHANNELS;
+    bool overlap = false;
+    bool addCorrected = false;
+    IOLoad ioLoad = DEFAULT_IOLOAD;
+    double ioRate = IO_RATE;
+    CPULoad cpuLoad = DEFAULT_CPULOAD;
+    int cpuThreads = 1;
 } Args;
 
-// A table containing:
-// - a scalar double TIME column
-// - an array[3] float UVW column
-// - an array[N_CHANS, N_POLS] complex DATA column
-Table setup_table(const String& tableName, Args args) {
-    if (args.verbosity > 0) {
-        cout << "setting up table" << endl;
-    }
-    Directory dir(tableName);
-    if (dir.exists()) {
-        if (args.verbosity > 0) cout << "removing existing table" << endl;
-        dir.removeRecursive();
-    }
-    // from https://casacore.github.io/casacore/group__Tables__module.html#Tables:creation
-    // Step1 -- Build the table description.
-    TableDesc td("tTableDesc", "1D", TableDesc::Scratch);
-    td.comment() = "A table with a single column of double values.";
-    ScalarColumnDesc<Double> timeColDesc("TIME");
-    ArrayColumnDesc<Float> uvwColDesc("UVW", IPosition(1, 3), ColumnDesc::Direct | ColumnDesc::FixedShape);
-    ArrayColumnDesc<Complex> dataColDesc("DATA", IPosition(2, args.nPols, args.nChs), ColumnDesc::FixedShape);
-    switch (args.tableType) {
-        case TIME:
-            td.addColumn (timeColDesc);
-            break;
-        case UVW:
-            td.addColumn (uvwColDesc);
-            break;
-        case DATA:
-            td.addColumn (dataColDesc);
-            break;
-        default:
-            td.addColumn (timeColDesc);
-            td.addColumn (uvwColDesc);
-            td.addColumn (dataColDesc);
-            break;
+// In USER lock mode the benchmark acquires the lock itself, a read lock in the
+// read paths and a write lock otherwise, either once per iteration or, with
+// -l, once per timestep. Unlocking flushes the table.
+void user_lock(Table& tab, Args& args, bool perTimestep, FileLocker::LockType lockType) {
+    if (args.lockMode == LOCK_USER && args.lockPerTimestep == perTimestep) {
+        tab.lock(lockType);
     }
+}
 
-    SetupNewTable newtab(tableName, td, Table::New);
-
-    Timer timer;
-    Table tab(newtab, args.nTimes * args.nBls);
-    if (args.verbosity > 0) {
-        std::cout << "table setup time: " << endl;
-        std::cout << "- user:   " << timer.user () << "s" << endl;
-        std::cout << "- system: " << timer.system () << "s" << endl;
-        std::cout << "- real:   " << timer.real () << "s" << endl;
+void user_unlock(Table& tab, Args& args, bool perTimestep) {
+    if (args.lockMode == LOCK_USER && args.lockPerTimestep == perTimestep) {
+        tab.unlock();
     }
-
-    return tab;
 }
 
-// Synthesize test data for the table
-void synthesize_data(Vector<Double>& times, Array<Float>& uvws, Array<Complex>& data, Args args) {
-    if (args.verbosity > 0) {
-        cout << "synthesizing data" << endl;
+// total up the number of files and their sizes below path
+void disk_usage(const std::string& path, long& nFiles, long long& nBytes) {
+    DIR* dir = opendir(path.c_str());
+    if (dir == NULL) {
+        throw std::runtime_error("could not open directory " + path);
     }
-    if (args.stream) {
-        switch (args.writeMode) {
-            case CELL:
-                times.resize(1);
-                uvws.resize(IPosition(2, 3, 1));
-                data.resize(IPosition(3, args.nPols, args.nChs, 1));
-                break;
-            case CELLS:
-                times.resize(args.nBls);
-                uvws.resize(IPosition(2, 3, args.nBls));
-                data.resize(IPosition(3, args.nPols, args.nChs, args.nBls));
-                break;
-            case COLUMN:
-                cerr << "warning: streaming a column does not avoid avoid slicing." << endl;
-                break;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        std::string name(entry->d_name);
+        if (name == "." || name == "..") continue;
+        std::string entryPath = path + "/" + name;
+        struct stat st;
+        if (stat(entryPath.c_str(), &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) {
+            disk_usage(entryPath, nFiles, nBytes);
+        } else {
+            nFiles++;
+            nBytes += st.st_size;
         }
     }
-    indgen(times);
-    // indgen(uvws);
-    IPosition uvwShape = uvws.shape();
-    IPosition dataShape = data.shape();
-    if (args.verbosity > 0) {
-        cout << "uvw shape: " << uvwShape << endl;
-        cout << "data shape: " << dataShape << endl;
+    closedir(dir);
+}
+
+// drop the files of a table from the page cache, so that the next reads of
+// them come from the disk (dirty pages are written back first)
+void evict_table(const std::string& path) {
+    DIR* dir = opendir(path.c_str());
+    if (dir == NULL) {
+        throw std::runtime_error("could not open directory " + path);
     }
-    for (int i = 0; i < uvwShape[1]; i++) {
-        for (int j = 0; j < uvwShape[0]; j++) {
-            uvws(IPosition(2, j, i)) = i + (j+1) * 0.1;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        std::string name(entry->d_name);
+        if (name == "." || name == "..") continue;
+        std::string entryPath = path + "/" + name;
+        struct stat st;
+        if (stat(entryPath.c_str(), &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) {
+            evict_table(entryPath);
+            continue;
         }
+        int fd = ::open(entryPath.c_str(), O_RDONLY);
+        if (fd < 0) continue;
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
     }
-    // indgen(data);
-    for (int i = 0; i < dataShape[2]; i++) {
-        for (int j = 0; j < dataShape[1]; j++) {
-            for (int k = 0; k < dataShape[0]; k++) {
-                data(IPosition(3, k, j, i)) = Complex(i, j + (k+1) * 0.1);
-            }
-        }
+    closedir(dir);
+}
+
+// tile shape for a cell shape in a tiled storage manager: whole cells by
+// -R rows, or by enough rows to make a tile of about TILE_BYTES.
+IPosition tile_shape(const IPosition& cellShape, int elementSize, rownr_t nRows, Args& args) {
+    rownr_t tileRows = args.tileRows;
+    if (args.tileRows <= 0) {
+        tileRows = std::max(1, (int)(TILE_BYTES / (cellShape.product() * elementSize)));
     }
-    if (args.writeMode == CELL) {
-        uvws.removeDegenerate();
-        data.removeDegenerate();
+    tileRows = std::min(tileRows, nRows);
+    IPosition shape(cellShape);
+    shape.append(IPosition(1, tileRows));
+    return shape;
+}
+
+// the virtual column of the engine, and the stored column holding its integers
+String engine_column(Args& args) {
+    return args.engineType == ENGINE_SCALEDARRAY ? "WEIGHT_SPECTRUM" : "DATA";
+}
+
+String engine_stored_column(Args& args) {
+    return engine_column(args) + "_SCALED";
+}
+
+// the largest magnitude of the values of the engine's column, from the range
+// of data_value and weight_value
+double engine_max_abs(Args& args) {
+    if (args.engineType == ENGINE_SCALEDARRAY) {
+        return 15 + args.nPols * 0.25;
     }
+    return std::max(args.nTimes * args.nBls - 1.0, args.nChs - 1 + args.nPols * 0.1);
 }
 
-// fill the time column by slicing times for the given write mode
-void fill_time_col(Table& tab, Vector<Double>& times, Args& args) {
-    ScalarColumn<Double> timeCol(tab, "TIME");
-    int nRows = args.nTimes * args.nBls;
-    switch (args.writeMode) {
-        case CELL:
-            for (int i = 0; i < nRows; i++) {
-                timeCol.put(i, times[i]);
-            }
+// The error allowed when validating the engine's column: one step of a 16 bit
+// integer over the whole range. CompressComplex scales each row to its own
+// range, so its steps are smaller.
+double engine_tolerance(Args& args) {
+    return engine_max_abs(args) / 32767;
+}
+
+// Add the stored columns of the engine to the description. CompressComplex
+// and CompressComplexSD pack the real and imaginary parts into an Int with a
+// scale and offset per row, ScaledComplexData stores them as two Shorts with
+// a fixed scale, and ScaledArrayEngine stores a Float array as Shorts.
+void describe_engine(TableDesc& td, Args& args) {
+    if (args.engineType == ENGINE_NONE) return;
+    String name = engine_column(args);
+    if (!td.isColumn(name)) {
+        throw std::runtime_error("engine " + std::string(engineTypeNames[args.engineType]) + " needs a " + name + " column");
+    }
+    if (args.engineType != ENGINE_SCALEDARRAY && args.dataElement != ELEMENT_COMPLEX) {
+        throw std::runtime_error("the complex engines store Complex DATA only");
+    }
+    IPosition cellShape = td.columnDesc(name).shape();
+    switch (args.engineType) {
+        case ENGINE_COMPRESS:
+        case ENGINE_COMPRESSSD:
+            td.addColumn(ArrayColumnDesc<Int>(engine_stored_column(args), cellShape, ColumnDesc::FixedShape));
+            td.addColumn(ScalarColumnDesc<Float>(name + "_SCALE"));
+            td.addColumn(ScalarColumnDesc<Float>(name + "_OFFSET"));
             break;
-        case CELLS:
-            for (int i = 0; i < args.nTimes; i++) {
-                Slicer chunker( IPosition(1, i * args.nBls), IPosition(1, args.nBls));
-                timeCol.putColumnRange(chunker, times(chunker));
-            }
+        case ENGINE_SCALED: {
+            IPosition storedShape(1, 2);
+            storedShape.append(cellShape);
+            td.addColumn(ArrayColumnDesc<Short>(engine_stored_column(args), storedShape, ColumnDesc::FixedShape));
             break;
-        case COLUMN:
-            timeCol.putColumn(times);
+        }
+        case ENGINE_SCALEDARRAY:
+            td.addColumn(ArrayColumnDesc<Short>(engine_stored_column(args), cellShape, ColumnDesc::FixedShape));
+            break;
+        default:
             break;
     }
 }
 
-// stream a pre-sliced array into into the time table.
-void stream_time_col(Table& tab, Vector<Double> times, Args& args) {
-    ScalarColumn<Double> timeCol(tab, "TIME");
-    int nRows = args.nTimes * args.nBls;
-    switch (args.writeMode) {
-        case CELL:
-            for (int i = 0; i < nRows; i++) {
-                timeCol.put(i, times[0]);
-            }
+// bind the virtual column to the engine, if the table has its stored column
+bool bind_engine(SetupNewTable& newtab, const TableDesc& td, Args& args) {
+    if (args.engineType == ENGINE_NONE || !td.isColumn(engine_stored_column(args))) return false;
+    String name = engine_column(args);
+    String stored = engine_stored_column(args);
+    Float scale = engine_max_abs(args) / 32767;
+    switch (args.engineType) {
+        case ENGINE_COMPRESS:
+            newtab.bindColumn(name, CompressComplex(name, stored, name + "_SCALE", name + "_OFFSET"));
             break;
-        case CELLS:
-            for (int i = 0; i < args.nTimes; i++) {
-                // Slicer chunker( IPosition(1, i * args.nBls), IPosition(1, args.nBls));
-                casacore::RefRows rownrs(i * args.nBls, (i + 1) * args.nBls - 1);
-                timeCol.putColumnCells(rownrs, times);
-            }
+        case ENGINE_COMPRESSSD:
+            newtab.bindColumn(name, CompressComplexSD(name, stored, name + "_SCALE", name + "_OFFSET"));
             break;
-        case COLUMN:
-            timeCol.putColumn(times);
+        case ENGINE_SCALED:
+            newtab.bindColumn(name, ScaledComplexData<Complex, Short>(name, stored, Complex(scale, scale)));
+            break;
+        case ENGINE_SCALEDARRAY:
+            newtab.bindColumn(name, ScaledArrayEngine<Float, Short>(name, stored, scale));
+            break;
+        default:
             break;
     }
+    return true;
 }
 
-void fill_uvw_col(Table& tab, Array<Float>& uvws, Args& args) {
-    ArrayColumn<Float> uvwCol(tab, "UVW");
-    int nRows = args.nTimes * args.nBls;
-    switch (args.writeMode) {
-        case CELL:
-            for (int i = 0; i < nRows; i++) {
-                Array<Float> row = uvws(Slicer(IPosition(2, 0, i), IPosition(2, Slicer::MimicSource, 1)));
-                row.removeDegenerate();
-                uvwCol.put(i, row);
-            }
-            break;
-        case CELLS:
-            for (int i = 0; i < args.nTimes; i++) {
-                casacore::RefRows rownrs(i * args.nBls, (i + 1) * args.nBls - 1);
-                Slicer chunker( IPosition(2, 0, i * args.nBls), IPosition(2, Slicer::MimicSource, args.nBls));
-                uvwCol.putColumnCells(rownrs, uvws(chunker));
-            }
-            break;
-        case COLUMN:
-            uvwCol.putColumn(uvws);
-            break;
+// bind the fixed shape array columns to the selected storage manager. Each
+// tiled column gets its own hypercolumn, scalar columns such as TIME stay in
+// the default StandardStMan.
+void bind_columns(SetupNewTable& newtab, const TableDesc& td, rownr_t nRows, Args& args) {
+    bool hasEngine = bind_engine(newtab, td, args);
+    if (args.stManType == STMAN_INCREMENTAL) {
+        newtab.bindAll(IncrementalStMan("ISM"));
+        return;
+    }
+    for (uInt i = 0; i < td.ncolumn(); i++) {
+        const ColumnDesc& colDesc = td.columnDesc(i);
+        if (!colDesc.isArray() || !colDesc.isFixedShape()) continue;
+        String name = colDesc.name();
+        if (hasEngine && name == engine_column(args)) continue;
+        IPosition cellShape = colDesc.shape();
+        int elementSize = ValType::getTypeSize(colDesc.dataType());
+        switch (args.stManType) {
+            case STMAN_TILEDCOLUMN:
+                newtab.bindColumn(name, TiledColumnStMan("Tiled" + name, tile_shape(cellShape, elementSize, nRows, args)));
+                break;
+            case STMAN_TILEDSHAPE:
+                newtab.bindColumn(name, TiledShapeStMan("Tiled" + name, tile_shape(cellShape, elementSize, nRows, args)));
+                break;
+            case STMAN_TILEDCELL:
+                newtab.bindColumn(name, TiledCellStMan("Tiled" + name, cellShape));
+                break;
+            default:
+                break;
+        }
     }
 }
 
-void stream_uvw_col(Table& tab, Array<Float>& uvws, Args& args) {
-    ArrayColumn<Float> uvwCol(tab, "UVW");
-    int nRows = args.nTimes * args.nBls;
-    switch (args.writeMode) {
-        case CELL:
-            for (int i = 0; i < nRows; i++) {
-                uvwCol.put(i, uvws);
-            }
+// add a fixed shape array column to an existing table, with the storage
+// manager bind_columns binds it to in a new table: its own tiled storage
+// manager, or by name the shared IncrementalStMan ("ISM") or the default
+// StandardStMan, which casacore names after its type
+void add_column(Table& tab, const String& name, const IPosition& cellShape, Args& args) {
+    ArrayColumnDesc<Complex> colDesc(name, cellShape, ColumnDesc::FixedShape);
+    int elementSize = sizeof(Complex);
+    switch (args.stManType) {
+        case STMAN_INCREMENTAL:
+            tab.addColumn(colDesc, "ISM", True);
             break;
-        case CELLS:
-            for (int i = 0; i < args.nTimes; i++) {
-                casacore::RefRows rownrs(i * args.nBls, (i + 1) * args.nBls - 1);
-                uvwCol.putColumnCells(rownrs, uvws);
-            }
+        case STMAN_TILEDCOLUMN:
+            tab.addColumn(colDesc, TiledColumnStMan("Tiled" + name, tile_shape(cellShape, elementSize, tab.nrow(), args)));
             break;
-        case COLUMN:
-            uvwCol.putColumn(uvws);
+        case STMAN_TILEDSHAPE:
+            tab.addColumn(colDesc, TiledShapeStMan("Tiled" + name, tile_shape(cellShape, elementSize, tab.nrow(), args)));
+            break;
+        case STMAN_TILEDCELL:
+            tab.addColumn(colDesc, TiledCellStMan("Tiled" + name, cellShape));
+            break;
+        default:
+            tab.addColumn(colDesc, "StandardStMan", True);
             break;
     }
 }
 
-void fill_data_col(Table& tab, Array<Complex>& data, Args& args) {
-    ArrayColumn<Complex> dataCol(tab, "DATA");
-    int nRows = args.nTimes * args.nBls;
-    switch (args.writeMode) {
-        case CELL:
-            for (int i = 0; i < nRows; i++) {
-                Array<Complex> row = data(Slicer(IPosition(3, 0, 0, i), IPosition(3, Slicer::MimicSource, Slicer::MimicSource, 1)));
-                row.removeDegenerate();
-                dataCol.put(i, row);
-            }
-            break;
-        case CELLS:
-            for (int i = 0; i < args.nTimes; i++) {
-                casacore::RefRows rownrs(i * args.nBls, (i + 1) * args.nBls - 1);
-                Slicer chunker( IPosition(3, 0, 0, i * args.nBls), IPosition(3, Slicer::MimicSource, Slicer::MimicSource, args.nBls));
-                dataCol.putColumnCells(rownrs, data(chunker));
-            }
-            break;
-        case COLUMN:
-            dataCol.putColumn(data);
-            break;
+// The data is always delivered time-major, index = time * nBls + baseline.
+// These map it to the rows of the table for the row order.
+rownr_t table_row(int index, Args& args) {
+    if (args.rowOrder == ORDER_TIME) {
+        return index;
     }
+    return (rownr_t)(index % args.nBls) * args.nTimes + index / args.nBls;
 }
 
-void stream_data_col(Table& tab, Array<Complex>& data, Args& args) {
-    ArrayColumn<Complex> dataCol(tab, "DATA");
-    int nRows = args.nTimes * args.nBls;
-    switch (args.writeMode) {
-        case CELL:
-            for (int i = 0; i < nRows; i++) {
-                dataCol.put(i, data);
-            }
+// the rows of one timestep
+RefRows timestep_rows(int t, Args& args) {
+    if (args.rowOrder == ORDER_TIME) {
+        return RefRows(t * args.nBls, (t + 1) * args.nBls - 1);
+    }
+    return RefRows(t, t + (args.nBls - 1) * args.nTimes, args.nTimes);
+}
+
+// the rows of one baseline across all timesteps
+RefRows baseline_rows(int baseline, Args& args) {
+    if (args.rowOrder == ORDER_TIME) {
+        return RefRows(baseline, baseline + (args.nTimes - 1) * args.nBls, args.nBls);
+    }
+    return RefRows(baseline * args.nTimes, (baseline + 1) * args.nTimes - 1);
+}
+
+// put a whole column delivered in time-major order
+template <typename C, typename A>
+void put_all_rows(C& col, const A& values, Args& args) {
+    if (args.rowOrder == ORDER_TIME) {
+        col.putColumn(values);
+        return;
+    }
+    Vector<rownr_t> rownrs(args.nTimes * args.nBls);
+    for (unsigned int i = 0; i < rownrs.size(); i++) {
+        rownrs[i] = table_row(i, args);
+    }
+    col.putColumnCells(RefRows(rownrs), values);
+}
+
+// get the cells of one timestep, as a contiguous range when time-major
+template <typename C, typename A>
+void get_timestep(C& col, int t, A& values, Args& args) {
+    if (args.rowOrder == ORDER_TIME) {
+        col.getColumnRange(Slicer( IPosition(1, t * args.nBls), IPosition(1, args.nBls)), values, True);
+    } else {
+        col.getColumnCells(timestep_rows(t, args), values, True);
+    }
+}
+
+// create a new table from the description with the storage, lock, endian and
+// tiled storage manager options, and the storage manager bindings.
+Table create_table(const String& tableName, const TableDesc& td, rownr_t nRows, Args& args) {
+    Directory dir(tableName);
+    if (dir.exists()) {
+        if (args.verbosity > 0) cout << "removing existing table" << endl;
+        dir.removeRecursive();
+    }
+
+    if (args.storageMode == STORAGE_MULTIHDF5 && !HDF5Object::hasHDF5Support()) {
+        throw std::runtime_error("MULTIHDF5 storage option needs casacore built with HDF5");
+    }
+    StorageOption storageOption(storageOptions[args.storageMode], args.blockSize);
+
+    // time the creation of the storage manager files as well as the table
+    Timer timer;
+    SetupNewTable newtab(tableName, td, Table::New, storageOption);
+    bind_columns(newtab, td, nRows, args);
+    Table tab(newtab, TableLock(tableLockOptions[args.lockMode]), nRows, False,
+        endianFormats[args.endianMode], TSMOption(tsmOptions[args.tsmMode]));
+    if (args.verbosity >= 0) {
+        std::cout << "table setup time: " << endl;
+        std::cout << "- user:   " << timer.user () << "s" << endl;
+        std::cout << "- system: " << timer.system () << "s" << endl;
+        std::cout << "- real:   " << timer.real () << "s" << endl;
+    }
+
+    return tab;
+}
+
+// reopen an existing table with the lock and tiled storage manager options
+Table open_table(const String& tableName, Args& args, Table::TableOption option = Table::Old) {
+    return Table(tableName, TableLock(tableLockOptions[args.lockMode]), option, TSMOption(tsmOptions[args.tsmMode]));
+}
+
+// the antennas of nBls baselines with autocorrelations
+int baseline_antennas(Args& args) {
+    return (int)((std::sqrt(8.0 * args.nBls + 1) - 1) / 2);
+}
+
+// the antenna pairs of the baselines, with autocorrelations, are (0, 0),
+// (0, 1) .. (0, nAnts-1), (1, 1) .. in the order of the rows of a timestep.
+// Returns the first antenna and sets the second (wrapping around when nBls
+// is not a whole number of antenna pairs).
+int baseline_antenna_pair(int baseline, int& antenna2, Args& args) {
+    int nAnts = baseline_antennas(args);
+    int antenna1 = 0;
+    while (antenna1 < nAnts - 1 && baseline >= nAnts - antenna1) {
+        baseline -= nAnts - antenna1;
+        antenna1++;
+    }
+    antenna2 = (antenna1 + baseline) % std::max(nAnts, 1);
+    return antenna1;
+}
+
+int baseline_antenna1(int baseline, Args& args) {
+    int antenna2;
+    return baseline_antenna_pair(baseline, antenna2, args);
+}
+
+// Generators of the synthetic values of the columns, from the time-major
+// index of the row (time * nBls + baseline) and the element's position in
+// the cell. TIME is the timestep index, which GROUP and QUERY rely on.
+void time_value(Double& value, int index, int, Args& args) {
+    value = index / args.nBls;
+}
+
+void uvw_value(Float& value, int index, int element, Args&) {
+    value = index + (element + 1) * 0.1;
+}
+
+template <typename T>
+void data_value(T& value, int index, int element, Args& args) {
+    value = T(index, element / args.nPols + (element % args.nPols + 1) * 0.1);
+}
+
+// a uniform value in [0, 1) from an integer (splitmix64), so that flags look
+// random but are the same in every run
+double unit_hash(unsigned long long x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return (x >> 11) * (1.0 / (1ULL << 53));
+}
+
+// the flagged fraction is -F, spread over the elements for RANDOM, or over
+// whole channels (like RFI) or whole baselines (like a dead antenna)
+void flag_value(Bool& value, int index, int element, Args& args) {
+    switch (args.flagPattern) {
+        case FLAGS_RANDOM:
+            value = unit_hash((unsigned long long)index * args.nPols * args.nChs + element) < args.flagDensity;
             break;
-        case CELLS:
-            for (int i = 0; i < args.nTimes; i++) {
-                casacore::RefRows rownrs(i * args.nBls, (i + 1) * args.nBls - 1);
-                dataCol.putColumnCells(rownrs, data);
-            }
+        case FLAGS_CHANNELS:
+            value = unit_hash(element / args.nPols) < args.flagDensity;
             break;
-        case COLUMN:
-            dataCol.putColumn(data);
+        case FLAGS_BASELINES:
+            value = unit_hash(index % args.nBls) < args.flagDensity;
             break;
     }
 }
 
-void fill_rowwise(Table& tab, Vector<Double>& times, Array<Float>& uvws, Array<Complex>& data, Args& args) {
-    ScalarColumn<Double> timeCol(tab, "TIME");
-    ArrayColumn<Float> uvwCol(tab, "UVW");
-    ArrayColumn<Complex> dataCol(tab, "DATA");
+void weight_value(Float& value, int index, int element, Args& args) {
+    value = (index % args.nBls) % 16 + (element % args.nPols + 1) * 0.25;
+}
+
+void antenna1_value(Int& value, int index, int, Args& args) {
+    value = baseline_antenna1(index % args.nBls, args);
+}
+
+bool has_flags(Args& args) {
+    return std::find(args.extraColumns.begin(), args.extraColumns.end(), COL_FLAG) != args.extraColumns.end();
+}
+
+// Time packing each row of FLAG into bits and unpacking it again, as the
+// storage managers do on every put and get of a Bool column, for the rows of
+// one iteration. Prints the cost per row and its share of the user time of
+// the timed iterations (packing when writing, unpacking in the read modes),
+// to show whether FLAG I/O is CPU bound.
+void report_flag_conversion(Args& args, double userTime) {
+    int cellSize = args.nPols * args.nChs;
+    int nBytes = (cellSize + 7) / 8;
+    std::vector<char> flags((size_t)args.nBls * cellSize);
+    std::vector<char> bits((size_t)args.nBls * nBytes);
+    long long nFlagged = 0;
+    for (int bl = 0; bl < args.nBls; bl++) {
+        for (int element = 0; element < cellSize; element++) {
+            Bool flag;
+            flag_value(flag, bl, element, args);
+            flags[(size_t)bl * cellSize + element] = flag;
+            nFlagged += flag;
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < args.nTimes; t++) {
+        for (int bl = 0; bl < args.nBls; bl++) {
+            Conversion::boolToBit(&bits[(size_t)bl * nBytes], &flags[(size_t)bl * cellSize], cellSize);
+        }
+    }
+    double packTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int t = 0; t < args.nTimes; t++) {
+        for (int bl = 0; bl < args.nBls; bl++) {
+            Conversion::bitToBool(&flags[(size_t)bl * cellSize], &bits[(size_t)bl * nBytes], cellSize);
+        }
+    }
+    double unpackTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
     int nRows = args.nTimes * args.nBls;
+    double conversionTime = (args.benchMode == WRITE ? packTime : unpackTime) * args.nIters;
+    std::cout << "flags:  " << (double)nFlagged / args.nBls / cellSize << " flagged" \
+        << ", pack=" << 1e6 * packTime / nRows << "us/row" \
+        << ", unpack=" << 1e6 * unpackTime / nRows << "us/row" \
+        << ", " << 100 * conversionTime / userTime << "% of user time" << endl;
+}
+
+// with -g the fill paths and validators generate each timestep when they need
+// it, except in COLUMN mode, which puts the whole column at once
+bool on_demand(Args& args) {
+    return args.generate && !args.stream && args.writeMode != COLUMN;
+}
+
+// cells to synthesize for a column: every row, one timestep when generating
+// on demand, or when streaming only the cells written at once, which are then
+// written to every row
+int synthesized_cells(Args& args) {
+    if (on_demand(args)) {
+        return args.nBls;
+    }
+    if (!args.stream || args.writeMode == COLUMN) {
+        return args.nTimes * args.nBls;
+    }
+    return args.writeMode == CELL ? 1 : args.nBls;
+}
+
+// One column of the benchmark table and its synthetic values, with the ways
+// to write, read and validate it. The values are delivered time-major, index
+// = time * nBls + baseline, and mapped to rows by table_row.
+class ColumnWorkload {
+  public:
+    ColumnWorkload(const String& name) : name(name) {}
+    virtual ~ColumnWorkload() {}
+    // add the column to a table description
+    virtual void describe(TableDesc& td) = 0;
+    // bytes in one cell in memory
+    virtual long long cellBytes() = 0;
+    virtual void synthesize(Args& args) = 0;
+    virtual void attach(const Table& tab) = 0;
+    // release the table, an attached column keeps it open
+    virtual void detach() = 0;
+    // put the cell of index i (CELL), the cells of timestep t (CELLS), or all cells (COLUMN)
+    virtual void putCell(int i, Args& args) = 0;
+    virtual void putTimestep(int t, Args& args) = 0;
+    virtual void putAll(Args& args) = 0;
+    // get the same cells back into a reused buffer
+    virtual void getCell(int i, Args& args) = 0;
+    virtual void getTimestep(int t, Args& args) = 0;
+    virtual void getAll() = 0;
+    virtual void getCells(const RefRows& rownrs) = 0;
+    // get the whole column of another table, e.g. a group of rows
+    virtual void getTable(const Table& tab) = 0;
+    // get one row, or nChannels channels of it from firstChannel on
+    virtual void getRow(rownr_t row, int firstChannel, int nChannels) = 0;
+    // get a [pols, chans] slice of the cells in a range of rows of a
+    // [nPols, nChs] column, returns the bytes got (0 for other columns)
+    virtual long long getSubCells(const Slicer& rows, const Slicer& cells) = 0;
+    // throw if the column in a table doesn't match the values within the
+    // tolerance, returns the largest error
+    virtual double compare(const Table& tab, Args& args) = 0;
+    // generate the values of the cells from index first on
+    virtual void generateCells(int first, Args& args) = 0;
+    // when generating on demand, make the values hold timestep t
+    void load_timestep(int t, Args& args) {
+        if (t == loadedTimestep) return;
+        auto start = std::chrono::steady_clock::now();
+        generateCells(t * args.nBls, args);
+        synthTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        loadedTimestep = t;
+    }
+    const String name;
+    double tolerance = 0;
+    // seconds spent generating timesteps on demand
+    double synthTime = 0;
+  protected:
+    int loadedTimestep = -1;
+};
+
+typedef std::vector<std::unique_ptr<ColumnWorkload>> Workloads;
+
+template <typename T>
+class ScalarWorkload : public ColumnWorkload {
+  public:
+    typedef void (*Generator)(T& value, int index, int element, Args& args);
+    ScalarWorkload(const String& name, Generator generate) : ColumnWorkload(name), generate(generate) {}
+    void describe(TableDesc& td) {
+        td.addColumn(ScalarColumnDesc<T>(name));
+    }
+    long long cellBytes() {
+        return sizeof(T);
+    }
+    void synthesize(Args& args) {
+        values.resize(synthesized_cells(args));
+        loadedTimestep = -1;
+        if (!on_demand(args)) {
+            generateCells(0, args);
+        }
+    }
+    void generateCells(int first, Args& args) {
+        for (unsigned int i = 0; i < values.size(); i++) {
+            generate(values[i], first + i, 0, args);
+        }
+    }
+    // the value of index i
+    const T& cell(int i, Args& args) {
+        if (!on_demand(args)) {
+            return values[i];
+        }
+        load_timestep(i / args.nBls, args);
+        return values[i % args.nBls];
+    }
+    void attach(const Table& tab) {
+        col.attach(tab, name);
+    }
+    void detach() {
+        col.reference(ScalarColumn<T>());
+    }
+    void putCell(int i, Args& args) {
+        col.put(table_row(i, args), args.stream ? values[0] : cell(i, args));
+    }
+    void putTimestep(int t, Args& args) {
+        if (args.stream) {
+            col.putColumnCells(timestep_rows(t, args), values);
+            return;
+        }
+        Slicer chunker( IPosition(1, t * args.nBls), IPosition(1, args.nBls));
+        // the values hold only this timestep when generating on demand
+        Slicer cells(chunker);
+        if (on_demand(args)) {
+            load_timestep(t, args);
+            cells = Slicer( IPosition(1, 0), IPosition(1, args.nBls));
+        }
+        if (args.rowOrder == ORDER_TIME) {
+            col.putColumnRange(chunker, values(cells));
+        } else {
+            col.putColumnCells(timestep_rows(t, args), values(cells));
+        }
+    }
+    void putAll(Args& args) {
+        if (args.stream) {
+            col.putColumn(values);
+        } else {
+            put_all_rows(col, values, args);
+        }
+    }
+    void getCell(int i, Args& args) {
+        col.get(table_row(i, args), value);
+    }
+    void getTimestep(int t, Args& args) {
+        get_timestep(col, t, buffer, args);
+    }
+    void getAll() {
+        col.getColumn(buffer, True);
+    }
+    void getCells(const RefRows& rownrs) {
+        col.getColumnCells(rownrs, buffer, True);
+    }
+    // a scalar has no channels
+    void getRow(rownr_t row, int, int) {
+        col.get(row, value);
+    }
+    long long getSubCells(const Slicer&, const Slicer&) {
+        return 0;
+    }
+    void getTable(const Table& tab) {
+        ScalarColumn<T>(tab, name).getColumn(buffer, True);
+    }
+    double compare(const Table& tab, Args& args) {
+        ScalarColumn<T> tabCol(tab, name);
+        for (int i = 0; i < args.nTimes * args.nBls; i++) {
+            rownr_t row = table_row(i, args);
+            if (tabCol(row) != cell(i, args)) {
+                std::ostringstream errStream;
+                errStream << name << " mismatch in " << tab.tableName() << " at row=" << row << ": " \
+                    << tabCol(row) << " != " << cell(i, args);
+                throw std::runtime_error(errStream.str());
+            }
+        }
+        return 0;
+    }
+  private:
+    Generator generate;
+    ScalarColumn<T> col;
+    Vector<T> values;
+    Vector<T> buffer;
+    T value;
+};
+
+template <typename T>
+class ArrayWorkload : public ColumnWorkload {
+  public:
+    typedef void (*Generator)(T& value, int index, int element, Args& args);
+    ArrayWorkload(const String& name, const IPosition& cellShape, Generator generate, int options = 0)
+        : ColumnWorkload(name), cellShape(cellShape), generate(generate), options(options) {}
+    void describe(TableDesc& td) {
+        td.addColumn(ArrayColumnDesc<T>(name, cellShape, ColumnDesc::FixedShape | options));
+    }
+    long long cellBytes() {
+        return cellShape.product() * sizeof(T);
+    }
+    void synthesize(Args& args) {
+        int nCells = synthesized_cells(args);
+        IPosition shape(cellShape);
+        shape.append(IPosition(1, nCells));
+        values.resize(shape);
+        loadedTimestep = -1;
+        if (!on_demand(args)) {
+            generateCells(0, args);
+        }
+        if (args.verbosity > 0) {
+            cout << name << " shape: " << values.shape() << endl;
+        }
+    }
+    void generateCells(int first, Args& args) {
+        int nCells = values.shape()[cellShape.size()];
+        int cellSize = cellShape.product();
+        Bool deleteIt;
+        T* storage = values.getStorage(deleteIt);
+        for (int i = 0; i < nCells; i++) {
+            for (int element = 0; element < cellSize; element++) {
+                generate(storage[i * cellSize + element], first + i, element, args);
+            }
+        }
+        values.putStorage(storage, deleteIt);
+    }
+    // the cell of index i
+    Array<T> cell(int i, Args& args) {
+        if (!on_demand(args)) {
+            return values[i];
+        }
+        load_timestep(i / args.nBls, args);
+        return values[i % args.nBls];
+    }
+    void attach(const Table& tab) {
+        col.attach(tab, name);
+    }
+    void detach() {
+        col.reference(ArrayColumn<T>());
+    }
+    void putCell(int i, Args& args) {
+        col.put(table_row(i, args), args.stream ? values[0] : cell(i, args));
+    }
+    void putTimestep(int t, Args& args) {
+        if (args.stream) {
+            col.putColumnCells(timestep_rows(t, args), values);
+            return;
+        }
+        IPosition start(values.ndim(), 0);
+        IPosition length(values.shape());
+        if (on_demand(args)) {
+            load_timestep(t, args);
+        } else {
+            start[cellShape.size()] = t * args.nBls;
+        }
+        length[cellShape.size()] = args.nBls;
+        col.putColumnCells(timestep_rows(t, args), values(Slicer(start, length)));
+    }
+    void putAll(Args& args) {
+        if (args.stream) {
+            col.putColumn(values);
+        } else {
+            put_all_rows(col, values, args);
+        }
+    }
+    void getCell(int i, Args& args) {
+        col.get(table_row(i, args), buffer, True);
+    }
+    void getTimestep(int t, Args& args) {
+        get_timestep(col, t, buffer, args);
+    }
+    void getAll() {
+        col.getColumn(buffer, True);
+    }
+    void getCells(const RefRows& rownrs) {
+        col.getColumnCells(rownrs, buffer, True);
+    }
+    void getRow(rownr_t row, int firstChannel, int nChannels) {
+        // a window of channels only applies to [nPols, nChs] cells
+        if (nChannels <= 0 || cellShape.size() != 2) {
+            col.get(row, buffer, True);
+            return;
+        }
+        Slicer channels(IPosition(2, 0, firstChannel), IPosition(2, cellShape[0], nChannels));
+        col.getSlice(row, channels, buffer, True);
+    }
+    long long getSubCells(const Slicer& rows, const Slicer& cells) {
+        if (cellShape.size() != 2) {
+            return 0;
+        }
+        col.getColumnRange(rows, cells, buffer, True);
+        return buffer.size() * sizeof(T);
+    }
+    void getTable(const Table& tab) {
+        ArrayColumn<T>(tab, name).getColumn(buffer, True);
+    }
+    double compare(const Table& tab, Args& args) {
+        ArrayColumn<T> tabCol(tab, name);
+        if (tabCol.nrow() != (rownr_t)args.nTimes * args.nBls) {
+            std::ostringstream errStream;
+            errStream << name << " row count mismatch in " << tab.tableName() << ": " << tabCol.nrow();
+            throw std::runtime_error(errStream.str());
+        }
+        double maxError = 0;
+        for (rownr_t i = 0; i < tabCol.nrow(); i++) {
+            rownr_t row = table_row(i, args);
+            Array<T> actual = tabCol(row);
+            Array<T> expected = cell(i, args);
+            if (args.verbosity > 0) {
+                std::cout << "actual: " << actual << endl;
+            }
+            if (actual.shape() != expected.shape()) {
+                std::ostringstream errStream;
+                errStream << name << " shape mismatch in " << tab.tableName() << " at row=" << row;
+                throw ArrayShapeError(actual.shape(), expected.shape(), errStream.str().c_str());
+            }
+            typename Array<T>::const_iterator actualIter = actual.begin();
+            typename Array<T>::const_iterator expectedIter = expected.begin();
+            for (int element = 0; actualIter != actual.end(); ++actualIter, ++expectedIter, ++element) {
+                double error = std::abs(*actualIter - *expectedIter);
+                if (error > tolerance) {
+                    std::ostringstream errStream;
+                    errStream << name << " value mismatch in " << tab.tableName() << " at row=" << row \
+                        << ", element " << element << ": " << *actualIter << " != " << *expectedIter \
+                        << " (delta=" << error << ")";
+                    throw std::runtime_error(errStream.str());
+                }
+                maxError = std::max(maxError, error);
+            }
+        }
+        return maxError;
+    }
+  private:
+    IPosition cellShape;
+    Generator generate;
+    int options;
+    ArrayColumn<T> col;
+    Array<T> values;
+    Array<T> buffer;
+};
+
+// The columns of the selected table type: TIME, UVW and DATA (or just one of
+// them), and the extra columns from -c, all with fixed cell shapes.
+Workloads make_workloads(Args& args) {
+    Workloads columns;
+    bool all = args.tableType == COLUMNWISE || args.tableType == ROWWISE;
+    IPosition dataShape(2, args.nPols, args.nChs);
+    if (all || args.tableType == TIME) {
+        columns.emplace_back(new ScalarWorkload<Double>("TIME", time_value));
+    }
+    if (all || args.tableType == UVW) {
+        columns.emplace_back(new ArrayWorkload<Float>("UVW", IPosition(1, 3), uvw_value, ColumnDesc::Direct));
+    }
+    if (all || args.tableType == DATA) {
+        if (args.dataElement == ELEMENT_DCOMPLEX) {
+            columns.emplace_back(new ArrayWorkload<DComplex>("DATA", dataShape, data_value<DComplex>));
+        } else {
+            columns.emplace_back(new ArrayWorkload<Complex>("DATA", dataShape, data_value<Complex>));
+        }
+    }
+    for (ExtraColumn column : args.extraColumns) {
+        switch (column) {
+            case COL_FLAG:
+                columns.emplace_back(new ArrayWorkload<Bool>("FLAG", dataShape, flag_value));
+                break;
+            case COL_WEIGHT_SPECTRUM:
+                columns.emplace_back(new ArrayWorkload<Float>("WEIGHT_SPECTRUM", dataShape, weight_value));
+                break;
+            case COL_ANTENNA1:
+                columns.emplace_back(new ScalarWorkload<Int>("ANTENNA1", antenna1_value));
+                break;
+        }
+    }
+    return columns;
+}
+
+// Synthesize test data for the columns
+void synthesize_data(Workloads& columns, Args& args) {
+    if (args.verbosity > 0) {
+        cout << "synthesizing data" << endl;
+    }
+    if (args.stream && args.writeMode == COLUMN) {
+        cerr << "warning: streaming a column does not avoid avoid slicing." << endl;
+    }
+    for (auto& column : columns) {
+        column->synthesize(args);
+    }
+}
+
+// write timestep t of the columns one cell at a time in CELL mode, or all of
+// its cells at once in CELLS mode
+void put_timestep(Table& tab, const std::vector<ColumnWorkload*>& columns, int t, Args& args) {
+    user_lock(tab, args, true, FileLocker::Write);
+    if (args.writeMode == CELL) {
+        for (int i = t * args.nBls; i < (t + 1) * args.nBls; i++) {
+            for (ColumnWorkload* column : columns) {
+                column->putCell(i, args);
+            }
+        }
+    } else {
+        for (ColumnWorkload* column : columns) {
+            column->putTimestep(t, args);
+        }
+    }
+    user_unlock(tab, args, true);
+}
+
+// write one iteration of a set of columns together, a row (CELL) or a
+// timestep (CELLS) of each column at a time, or each whole column (COLUMN)
+void put_columns(Table& tab, const std::vector<ColumnWorkload*>& columns, Args& args) {
     switch (args.writeMode) {
         case CELL:
-            for (int i = 0; i < nRows; i++) {
-                timeCol.put(i, times[i]);
-                Array<Float> uvw = uvws(Slicer(IPosition(2, 0, i), IPosition(2, Slicer::MimicSource, 1)));
-                uvw.removeDegenerate();
-                uvwCol.put(i, uvw);
-                Array<Complex> row = data(Slicer(IPosition(3, 0, 0, i), IPosition(3, Slicer::MimicSource, Slicer::MimicSource, 1)));
-                row.removeDegenerate();
-                dataCol.put(i, row);
-            }
-            break;
         case CELLS:
             for (int i = 0; i < args.nTimes; i++) {
-                Slicer chunker( IPosition(1, i * args.nBls), IPosition(1, args.nBls));
-                timeCol.putColumnRange(chunker, times(chunker));
-                chunker = Slicer( IPosition(2, 0, i * args.nBls), IPosition(2, Slicer::MimicSource, args.nBls));
-                Array<Float> uvwChunk = uvws(chunker);
-                casacore::RefRows rownrs(i * args.nBls, (i + 1) * args.nBls - 1);
-                uvwCol.putColumnCells(rownrs, uvwChunk);
-                chunker = Slicer( IPosition(3, 0, 0, i * args.nBls), IPosition(3, Slicer::MimicSource, Slicer::MimicSource, args.nBls));
-                Array<Complex> dataChunk = data(chunker);
-                dataCol.putColumnCells(rownrs, dataChunk);
+                put_timestep(tab, columns, i, args);
             }
             break;
         case COLUMN:
-            throw std::runtime_error("can't write rowwise in COLUMN mode");
+            if (args.tableType == ROWWISE) {
+                throw std::runtime_error("can't write rowwise in COLUMN mode");
+            }
+            user_lock(tab, args, true, FileLocker::Write);
+            for (ColumnWorkload* column : columns) {
+                column->putAll(args);
+            }
+            user_unlock(tab, args, true);
+            break;
     }
 }
 
-void stream_rowwise(Table& tab, Vector<Double>& times, Array<Float>& uvws, Array<Complex>& data, Args& args) {
-    ScalarColumn<Double> timeCol(tab, "TIME");
-    ArrayColumn<Float> uvwCol(tab, "UVW");
-    ArrayColumn<Complex> dataCol(tab, "DATA");
+// read the cells back in the pattern of the write mode
+void get_columns(Table& tab, const std::vector<ColumnWorkload*>& columns, Args& args) {
     int nRows = args.nTimes * args.nBls;
     switch (args.writeMode) {
         case CELL:
             for (int i = 0; i < nRows; i++) {
-                timeCol.put(i, times[0]);
-                uvwCol.put(i, uvws);
-                dataCol.put(i, data);
+                if (i % args.nBls == 0) user_lock(tab, args, true, FileLocker::Read);
+                for (ColumnWorkload* column : columns) {
+                    column->getCell(i, args);
+                }
+                if (i % args.nBls == args.nBls - 1) user_unlock(tab, args, true);
             }
             break;
         case CELLS:
             for (int i = 0; i < args.nTimes; i++) {
-                casacore::RefRows rownrs(i * args.nBls, (i + 1) * args.nBls - 1);
-                // Slicer chunker( IPosition(1, i * args.nBls), IPosition(1, args.nBls));
-                timeCol.putColumnCells(rownrs, times);
-                uvwCol.putColumnCells(rownrs, uvws);
-                dataCol.putColumnCells(rownrs, data);
+                user_lock(tab, args, true, FileLocker::Read);
+                for (ColumnWorkload* column : columns) {
+                    column->getTimestep(i, args);
+                }
+                user_unlock(tab, args, true);
+            }
+            break;
+        case COLUMN:
+            if (args.tableType == ROWWISE) {
+                throw std::runtime_error("can't read rowwise in COLUMN mode");
+            }
+            user_lock(tab, args, true, FileLocker::Read);
+            for (ColumnWorkload* column : columns) {
+                column->getAll();
+            }
+            user_unlock(tab, args, true);
+            break;
+    }
+}
+
+// ROWWISE writes or reads all columns together, the other table types one
+// whole column after another
+std::vector<std::vector<ColumnWorkload*>> column_passes(Table& tab, Workloads& columns, Args& args) {
+    std::vector<std::vector<ColumnWorkload*>> passes;
+    for (auto& column : columns) {
+        column->attach(tab);
+        if (args.tableType != ROWWISE || passes.empty()) {
+            passes.push_back(std::vector<ColumnWorkload*>());
+        }
+        passes.back().push_back(column.get());
+    }
+    return passes;
+}
+
+// write one iteration of the selected table type
+void write_table(Table& tab, Workloads& columns, Args& args) {
+    for (auto& pass : column_passes(tab, columns, args)) {
+        put_columns(tab, pass, args);
+    }
+}
+
+// Close the table, so that it is reopened from disk with the tiled storage
+// manager option and empty caches rather than found in the table cache. The
+// workloads' columns keep it open, so they are detached first.
+void close_table(Table& tab, Workloads& columns) {
+    String tableName = tab.tableName();
+    for (auto& column : columns) {
+        column->detach();
+    }
+    tab = Table();
+    if (Table::isOpened(tableName)) {
+        throw std::runtime_error("table " + tableName + " is still open after closing it");
+    }
+}
+
+// read one iteration of the selected table type
+void read_table(Table& tab, Workloads& columns, Args& args) {
+    for (auto& pass : column_passes(tab, columns, args)) {
+        get_columns(tab, pass, args);
+    }
+}
+
+// bytes in one row of the columns of the selected table type
+long long row_bytes(Workloads& columns) {
+    long long nBytes = 0;
+    for (auto& column : columns) {
+        nBytes += column->cellBytes();
+    }
+    return nBytes;
+}
+
+// A table with the columns of the workloads, by default:
+// - a scalar double TIME column
+// - an array[3] float UVW column
+// - an array[N_POLS, N_CHANS] complex DATA column
+Table setup_table(const String& tableName, Workloads& columns, Args& args) {
+    if (args.verbosity > 0) {
+        cout << "setting up table" << endl;
+    }
+    // from https://casacore.github.io/casacore/group__Tables__module.html#Tables:creation
+    // Step1 -- Build the table description.
+    TableDesc td("tTableDesc", "1D", TableDesc::Scratch);
+    td.comment() = "A table with the columns of a visibility workload.";
+    for (auto& column : columns) {
+        column->describe(td);
+    }
+    describe_engine(td, args);
+    // APPLYCAL writes CORRECTED_DATA, which the fill leaves undefined
+    if (args.benchMode == APPLYCAL && !args.addCorrected) {
+        td.addColumn(ArrayColumnDesc<Complex>("CORRECTED_DATA", IPosition(2, args.nPols, args.nChs), ColumnDesc::FixedShape));
+    }
+
+    return create_table(tableName, td, args.nTimes * args.nBls, args);
+}
+
+// print cpu and wall time, throughput, page faults and peak memory since the
+// timer was started and the usage was sampled. The throughput is over the wall
+// time, or over busyTime when the run also waits.
+void report(Timer& timer, struct rusage& usageBefore, double nBytes, double busyTime = 0) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << "user:   " << timer.user () << "s" << endl;
+    std::cout << "system: " << timer.system () << "s" << endl;
+    std::cout << "real:   " << timer.real () << "s" << endl;
+    std::cout << "rate:   " << nBytes / (busyTime > 0 ? busyTime : timer.real ()) / (1024 * 1024) << " MiB/s" << endl;
+    std::cout << "faults: " << usage.ru_minflt - usageBefore.ru_minflt << " minor, " \
+        << usage.ru_majflt - usageBefore.ru_majflt << " major" << endl;
+    std::cout << "maxrss: " << usage.ru_maxrss << " KiB" << endl;
+}
+
+// Print the largest quantisation error of the engine's column against the
+// synthetic values, and the bytes its stored column takes per row.
+void report_engine(Table& tab, Workloads& columns, Args& args) {
+    tab.flush();
+    for (auto& column : columns) {
+        if (column->name != engine_column(args)) continue;
+        column->tolerance = INFINITY;
+        double maxError = column->compare(tab, args);
+        const ColumnDesc& storedDesc = tab.tableDesc().columnDesc(engine_stored_column(args));
+        long long storedBytes = storedDesc.shape().product() * ValType::getTypeSize(storedDesc.dataType());
+        std::cout << "engine: " << engineTypeNames[args.engineType] << ", max error=" << maxError \
+            << " (" << 100 * maxError / engine_max_abs(args) << "% of the largest value), stored " \
+            << storedBytes << " of " << column->cellBytes() << " bytes per row" << endl;
+    }
+}
+
+// the throughput and times of one repetition of the timed iterations
+struct Repetition {
+    double rate;
+    double real;
+    double user;
+    double system;
+};
+
+// Generating on demand happens inside the timed loop, so report how much of
+// the real time went to it rather than to the table.
+void report_synthesis(Workloads& columns, const std::vector<Repetition>& repetitions) {
+    double synthTime = 0, realTime = 0;
+    for (auto& column : columns) {
+        synthTime += column->synthTime;
+    }
+    for (const Repetition& repetition : repetitions) {
+        realTime += repetition.real;
+    }
+    std::cout << "synth:  " << synthTime << "s generating data on demand (" \
+        << 100 * synthTime / realTime << "% of real)" << endl;
+}
+
+// Summarize repetitions with outliers rejected. The user, system, real and
+// rate lines are the means, so they read like the report of a single run.
+void report_repetitions(const std::vector<Repetition>& repetitions, struct rusage& usageBefore, Args& args) {
+    std::vector<double> rates, reals, users, systems;
+    for (const Repetition& rep : repetitions) {
+        rates.push_back(rep.rate);
+        reals.push_back(rep.real);
+        users.push_back(rep.user);
+        systems.push_back(rep.system);
+        if (args.verbosity >= 1) {
+            std::cout << "repetition: " << rep.rate << " MiB/s, real " << rep.real << "s, user " << rep.user \
+                << "s, system " << rep.system << "s" << endl;
+        }
+    }
+    Summary rate = summarize(rates, true);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << "user:   " << summarize(users, true).mean << "s" << endl;
+    std::cout << "system: " << summarize(systems, true).mean << "s" << endl;
+    std::cout << "real:   " << summarize(reals, true).mean << "s" << endl;
+    std::cout << "rate:   " << rate.mean << " MiB/s" << endl;
+    std::cout << "stats:  n=" << rate.n << " (" << rate.nOutliers << " outliers rejected)" \
+        << ", mean=" << rate.mean << ", median=" << rate.median << ", stddev=" << rate.stddev \
+        << ", 95% CI=[" << rate.mean - rate.ci95 << ", " << rate.mean + rate.ci95 << "] MiB/s" << endl;
+    std::cout << "faults: " << usage.ru_minflt - usageBefore.ru_minflt << " minor, " \
+        << usage.ru_majflt - usageBefore.ru_majflt << " major" << endl;
+    std::cout << "maxrss: " << usage.ru_maxrss << " KiB" << endl;
+}
+
+// one line per repetition, read by ./runner -c
+void write_results(const std::string& resultsName, const std::vector<Repetition>& repetitions) {
+    std::ofstream results(resultsName);
+    if (!results) {
+        throw std::runtime_error("could not open results file: " + resultsName);
+    }
+    results << "# rate(MiB/s) real(s) user(s) system(s)" << endl;
+    for (const Repetition& rep : repetitions) {
+        results << rep.rate << " " << rep.real << " " << rep.user << " " << rep.system << endl;
+    }
+}
+
+// print the distribution of per group (or per request) latencies
+void report_latency(const char* name, std::vector<double>& latencies) {
+    if (latencies.empty()) return;
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (double latency : latencies) total += latency;
+    std::cout << name << " latency: n=" << latencies.size() \
+        << ", mean=" << 1e3 * total / latencies.size() << "ms" \
+        << ", median=" << 1e3 * latencies[latencies.size() / 2] << "ms" \
+        << ", min=" << 1e3 * latencies.front() << "ms" \
+        << ", max=" << 1e3 * latencies.back() << "ms" << endl;
+}
+
+// read every column of the selected table type from all rows of a group
+void read_group(Table& group, Workloads& columns) {
+    for (auto& column : columns) {
+        column->getTable(group);
+    }
+}
+
+// read the table one timestep at a time, the way calibration and imaging do:
+// - ITERATOR: a TableIterator over TIME, which sorts and builds a RefTable per group
+// - RANGE: getColumnRange over each timestep's block of rows (or
+//   getColumnCells on its strided rows when baseline-major)
+// - SELECT: a TableExprNode selection on TIME, which builds a RefTable per group
+// each method is timed separately, with the latency of each group.
+void bench_groups(Table& tab, Workloads& columns, Args& args) {
+    if (args.tableType == UVW || args.tableType == DATA) {
+        throw std::runtime_error("grouping by TIME needs a TIME column");
+    }
+    const char* methods[] = {"ITERATOR", "RANGE", "SELECT"};
+    for (int method = 0; method < 3; method++) {
+        std::vector<double> latencies;
+        struct rusage usageBefore;
+        getrusage(RUSAGE_SELF, &usageBefore);
+        Timer timer;
+        for (int i = 0; i < args.nIters; i++) {
+            user_lock(tab, args, false, FileLocker::Read);
+            for (auto& column : columns) {
+                column->attach(tab);
+            }
+            if (method == 0) {
+                TableIterator iter(tab, "TIME");
+                while (!iter.pastEnd()) {
+                    auto start = std::chrono::steady_clock::now();
+                    Table group = iter.table();
+                    read_group(group, columns);
+                    latencies.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                    iter.next();
+                }
+            } else {
+                for (int t = 0; t < args.nTimes; t++) {
+                    auto start = std::chrono::steady_clock::now();
+                    if (method == 1) {
+                        for (auto& column : columns) {
+                            column->getTimestep(t, args);
+                        }
+                    } else {
+                        // TIME is the timestep index, see time_value
+                        Table group = tab(tab.col("TIME") == Double(t));
+                        read_group(group, columns);
+                    }
+                    latencies.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                }
+            }
+            user_unlock(tab, args, false);
+        }
+        std::cout << "## group: " << methods[method] << endl;
+        report(timer, usageBefore, (double)args.nIters * args.nTimes * args.nBls * row_bytes(columns));
+        report_latency("group", latencies);
+        if (args.nIters > 0 && has_flags(args)) {
+            report_flag_conversion(args, timer.user());
+        }
+    }
+}
+
+// Simulate a correlator: timestep t is released at t * cadence seconds on a
+// monotonic clock (continuing over the iterations) and written with the write
+// mode, all columns together, as soon as it is released and the previous one
+// is done. A timestep misses its deadline when it isn't written before the
+// next one is released; the backlog is the number of released timesteps still
+// waiting when one is done.
+void bench_ingest(Table& tab, Workloads& columns, Args& args) {
+    if (args.writeMode == COLUMN) {
+        throw std::runtime_error("can't ingest in COLUMN mode, timesteps arrive one at a time");
+    }
+    if (args.cadence <= 0) {
+        throw std::runtime_error("cadence must be positive");
+    }
+    typedef std::chrono::steady_clock Clock;
+    std::vector<ColumnWorkload*> all;
+    for (auto& column : columns) {
+        column->attach(tab);
+        all.push_back(column.get());
+    }
+    std::vector<double> latencies;
+    // the time spent writing, without the waits for the next release
+    double putTime = 0;
+    int nMissed = 0;
+    int maxBacklog = 0;
+    long long nReleased = (long long)args.nIters * args.nTimes;
+    struct rusage usageBefore;
+    getrusage(RUSAGE_SELF, &usageBefore);
+    Timer timer;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < args.nIters; i++) {
+        if (args.verbosity >= 0) {
+            cerr << "iteration " << i + 1 << " of " << args.nIters << "\r";
+        }
+        user_lock(tab, args, false, FileLocker::Write);
+        for (int t = 0; t < args.nTimes; t++) {
+            long long n = (long long)i * args.nTimes + t;
+            Clock::time_point release = start + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(n * args.cadence));
+            std::this_thread::sleep_until(release);
+            Clock::time_point putStart = Clock::now();
+            put_timestep(tab, all, t, args);
+            Clock::time_point putEnd = Clock::now();
+            putTime += std::chrono::duration<double>(putEnd - putStart).count();
+            double latency = std::chrono::duration<double>(putEnd - release).count();
+            latencies.push_back(latency);
+            if (latency > args.cadence) {
+                nMissed++;
+            }
+            long long arrived = std::min(n + (long long)(latency / args.cadence), nReleased - 1);
+            maxBacklog = std::max(maxBacklog, (int)(arrived - n));
+        }
+        user_unlock(tab, args, false);
+    }
+    if (args.nIters > 0) {
+        cerr << "                          \r";
+        double timestepBytes = (double)args.nBls * row_bytes(columns);
+        report(timer, usageBefore, nReleased * timestepBytes, putTime);
+        report_latency("timestep", latencies);
+        std::cout << "deadline: " << nMissed << " of " << nReleased << " timesteps missed the " \
+            << args.cadence << "s cadence, max backlog=" << maxBacklog << " timesteps, needs " \
+            << timestepBytes / args.cadence / (1024 * 1024) << " MiB/s" << endl;
+    }
+}
+
+// print the rate and latency percentiles of single reads
+void report_reads(const std::string& name, std::vector<double>& latencies) {
+    if (latencies.empty()) return;
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (double latency : latencies) total += latency;
+    auto percentile = [&latencies](double p) {
+        return 1e3 * latencies[std::min(latencies.size() - 1, (size_t)(p * latencies.size()))];
+    };
+    std::cout << name << ": n=" << latencies.size() << ", iops=" << latencies.size() / total \
+        << ", p50=" << percentile(0.5) << "ms" \
+        << ", p99=" << percentile(0.99) << "ms" \
+        << ", p999=" << percentile(0.999) << "ms" \
+        << ", max=" << 1e3 * latencies.back() << "ms" << endl;
+}
+
+// Read -n rows chosen with a seeded RNG (with --read-channels, a random window
+// of that many channels of each row of the array columns), the way viewers and
+// flag editors fetch scattered data. Each column is read on its own: cold after
+// closing the table and dropping its files from the page cache, then warm by
+// reading the same rows again. Each iteration repeats the cold and warm pass.
+void bench_random(Table& tab, Workloads& columns, Args& args) {
+    if (args.readChannels > args.nChs) {
+        throw std::runtime_error("can't read more channels than the cells have");
+    }
+    std::mt19937_64 random(args.seed);
+    rownr_t nRows = tab.nrow();
+    std::vector<rownr_t> rows(args.nReads);
+    std::vector<int> firstChannels(args.nReads, 0);
+    for (int i = 0; i < args.nReads; i++) {
+        rows[i] = random() % nRows;
+        if (args.readChannels > 0) {
+            firstChannels[i] = random() % (args.nChs - args.readChannels + 1);
+        }
+    }
+    String tableName = tab.tableName();
+    for (auto& column : columns) {
+        std::vector<double> cold, warm;
+        for (int i = 0; i < args.nIters; i++) {
+            if (args.verbosity >= 0) {
+                cerr << column->name << " iteration " << i + 1 << " of " << args.nIters << "\r";
+            }
+            // detach every column so that the table really closes and its
+            // storage manager caches go with it, not only the page cache
+            close_table(tab, columns);
+            evict_table(tableName);
+            tab = open_table(tableName, args);
+            column->attach(tab);
+            user_lock(tab, args, false, FileLocker::Read);
+            for (std::vector<double>* latencies : {&cold, &warm}) {
+                for (int read = 0; read < args.nReads; read++) {
+                    auto start = std::chrono::steady_clock::now();
+                    column->getRow(rows[read], firstChannels[read], args.readChannels);
+                    latencies->push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                }
+            }
+            user_unlock(tab, args, false);
+        }
+        if (args.nIters > 0) {
+            cerr << "                                        \r";
+            report_reads(column->name + " cold", cold);
+            report_reads(column->name + " warm", warm);
+        }
+    }
+}
+
+// the number of indices a range selects along an axis of n, or throw when it
+// runs past the end
+int range_length(const Range& range, int n, const char* axis) {
+    int width = range.width > 0 ? range.width : (n - range.start + range.stride - 1) / range.stride;
+    if (width <= 0 || range.start + (width - 1) * range.stride >= n) {
+        throw std::runtime_error(std::string(axis) + " range runs past the " + std::to_string(n) + " in a cell");
+    }
+    return width;
+}
+
+// the read syscall bytes (rchar) and the bytes fetched from the storage layer
+// (read_bytes) of this process so far, from /proc/self/io
+void io_counters(long long& rchar, long long& readBytes) {
+    rchar = readBytes = 0;
+    std::ifstream file("/proc/self/io");
+    std::string key;
+    long long value;
+    while (file >> key >> value) {
+        if (key == "rchar:") rchar = value;
+        if (key == "read_bytes:") readBytes = value;
+    }
+}
+
+// Read a [pols, chans] slice (--pols, --channels) of the cells of the
+// [nPols, nChs] columns over all rows, a timestep of rows at a time with
+// getColumnRange(rowSlicer, cellSlicer), from a cold page cache in each
+// iteration, which is summarized like a repetition. The rate is of the
+// useful bytes in the slices, against the bytes
+// read from the storage layer, which tiled storage managers can keep close to
+// it while StandardStMan reads whole cells.
+void bench_slice(Table& tab, Workloads& columns, Args& args) {
+    int nPols = range_length(args.pols, args.nPols, "polarisation");
+    int nChannels = range_length(args.channels, args.nChs, "channel");
+    Slicer cells(IPosition(2, args.pols.start, args.channels.start), IPosition(2, nPols, nChannels),
+        IPosition(2, args.pols.stride, args.channels.stride));
+    String tableName = tab.tableName();
+    double usefulBytes = 0;
+    long long rcharTotal = 0, readBytesTotal = 0;
+    std::vector<Repetition> iterations;
+    struct rusage usageBefore;
+    getrusage(RUSAGE_SELF, &usageBefore);
+    for (int i = 0; i < args.nIters; i++) {
+        if (args.verbosity >= 0) {
+            cerr << "iteration " << i + 1 << " of " << args.nIters << "\r";
+        }
+        // closing detaches the columns, so the tile caches are dropped too
+        close_table(tab, columns);
+        evict_table(tableName);
+        tab = open_table(tableName, args);
+        for (auto& column : columns) {
+            column->attach(tab);
+        }
+        long long rcharBefore, readBytesBefore;
+        io_counters(rcharBefore, readBytesBefore);
+        // evicting and reopening the table is not timed
+        Timer timer;
+        double iterationBytes = 0;
+        user_lock(tab, args, false, FileLocker::Read);
+        for (int t = 0; t < args.nTimes; t++) {
+            Slicer rows(IPosition(1, t * args.nBls), IPosition(1, args.nBls));
+            for (auto& column : columns) {
+                iterationBytes += column->getSubCells(rows, cells);
+            }
+        }
+        user_unlock(tab, args, false);
+        iterations.push_back(Repetition{iterationBytes / timer.real() / (1024 * 1024), timer.real(), timer.user(), timer.system()});
+        usefulBytes += iterationBytes;
+        long long rchar, readBytes;
+        io_counters(rchar, readBytes);
+        rcharTotal += rchar - rcharBefore;
+        readBytesTotal += readBytes - readBytesBefore;
+    }
+    if (args.nIters > 0) {
+        cerr << "                          \r";
+        report_repetitions(iterations, usageBefore, args);
+        std::cout << "slice:  [" << nPols << ", " << nChannels << "] of [" << args.nPols << ", " << args.nChs \
+            << "] per cell, " << usefulBytes / (1024 * 1024) << " MiB useful" << endl;
+        std::cout << "io:     " << readBytesTotal / (1024.0 * 1024) << " MiB read_bytes (" \
+            << readBytesTotal / usefulBytes << "x useful), " << rcharTotal / (1024.0 * 1024) << " MiB rchar" << endl;
+    }
+}
+
+// Average a chunk of nTimes timesteps of [nPols, nChs] cells (nBls per
+// timestep) over the times and each run of nAverage channels into nBls cells
+// of [nPols, nChs / nAverage], leaving out flagged elements when there are
+// flags. An output element is flagged when all of its inputs are. The inner
+// loops run over contiguous elements with a 0 or 1 weight instead of a branch,
+// so that the compiler can vectorise them.
+void average_chunk(const Complex* data, const Bool* flags, Complex* outData, Bool* outFlags,
+        int nPols, int nChs, int nBls, int nTimes, int nAverage) {
+    int nOut = nChs / nAverage * nPols;
+    std::vector<Complex> sums(nOut);
+    std::vector<float> weights(nOut);
+    for (int bl = 0; bl < nBls; bl++) {
+        std::fill(sums.begin(), sums.end(), Complex(0, 0));
+        std::fill(weights.begin(), weights.end(), 0.0f);
+        for (int t = 0; t < nTimes; t++) {
+            size_t cell = ((size_t)t * nBls + bl) * nPols * nChs;
+            for (int out = 0; out < nOut; out += nPols) {
+                for (int ch = 0; ch < nAverage; ch++) {
+                    size_t in = cell + (size_t)out * nAverage + ch * nPols;
+                    for (int pol = 0; pol < nPols; pol++) {
+                        float weight = flags ? !flags[in + pol] : 1.0f;
+                        sums[out + pol] += data[in + pol] * weight;
+                        weights[out + pol] += weight;
+                    }
+                }
+            }
+        }
+        for (int out = 0; out < nOut; out++) {
+            outData[(size_t)bl * nOut + out] = weights[out] > 0 ? sums[out] / weights[out] : Complex(0, 0);
+            if (outFlags) {
+                outFlags[(size_t)bl * nOut + out] = weights[out] == 0;
+            }
+        }
+    }
+}
+
+// a chunk of timesteps in the REDUCE pipeline, read and then averaged
+struct ReduceChunk {
+    Array<Complex> data;
+    Array<Bool> flags;
+    Vector<Double> times;
+    Array<Complex> outData;
+    Array<Bool> outFlags;
+    Vector<Double> outTimes;
+};
+
+// the real time of each stage of the REDUCE pipeline, and of the pipeline
+// as a whole, which is less than their sum when they overlap
+struct ReduceStages {
+    double read = 0;
+    double compute = 0;
+    double write = 0;
+    double pipeline = 0;
+};
+
+// Create the table REDUCE writes: nTimes / times timesteps of DATA (and FLAG
+// and TIME when the input has them) averaged by --average, with the storage
+// options of the benchmark.
+Table create_reduced_table(const Table& tab, Args& args) {
+    if (!tab.tableDesc().isColumn("DATA") || args.dataElement != ELEMENT_COMPLEX) {
+        throw std::runtime_error("REDUCE needs a COMPLEX DATA column");
+    }
+    if (args.rowOrder != ORDER_TIME) {
+        throw std::runtime_error("REDUCE reads chunks of time-ordered rows");
+    }
+    int nTimes = args.averageTimes, nAverage = args.averageChannels;
+    if (nTimes < 1 || nAverage < 1 || nTimes > args.nTimes || args.nChs % nAverage != 0) {
+        throw std::runtime_error("can't average " + std::to_string(args.nTimes) + " timesteps of " \
+            + std::to_string(args.nChs) + " channels by " + std::to_string(nTimes) + ":" + std::to_string(nAverage));
+    }
+    IPosition outShape(2, args.nPols, args.nChs / nAverage);
+    TableDesc td("tReducedDesc", "1", TableDesc::Scratch);
+    td.addColumn(ArrayColumnDesc<Complex>("DATA", outShape, ColumnDesc::FixedShape));
+    if (tab.tableDesc().isColumn("FLAG")) {
+        td.addColumn(ArrayColumnDesc<Bool>("FLAG", outShape, ColumnDesc::FixedShape));
+    }
+    if (tab.tableDesc().isColumn("TIME")) {
+        td.addColumn(ScalarColumnDesc<Double>("TIME"));
+    }
+    // the output stores DATA directly, even when the input goes through an engine
+    Args outArgs = args;
+    outArgs.engineType = ENGINE_NONE;
+    return create_table("/tmp/table.reduced/", td, (rownr_t)(args.nTimes / nTimes) * args.nBls, outArgs);
+}
+
+// Read DATA (with FLAG and TIME when the table has them) a chunk of --average
+// timesteps at a time, average it over the timesteps and channels, and write
+// the result to the reduced table, timing each stage. With --overlap the
+// averaging of a chunk runs in a thread while the main thread writes the
+// previous chunk and reads the next one, so that I/O and compute overlap; all
+// table access stays on the main thread since casacore is not thread safe.
+void reduce_table(Table& tab, Table& outTab, ReduceStages& stages, Args& args) {
+    int nTimes = args.averageTimes, nAverage = args.averageChannels;
+    bool hasFlags = tab.tableDesc().isColumn("FLAG");
+    bool hasTimes = tab.tableDesc().isColumn("TIME");
+    int nChunks = args.nTimes / nTimes;
+    IPosition outShape(3, args.nPols, args.nChs / nAverage, args.nBls);
+
+    ArrayColumn<Complex> data(tab, "DATA");
+    ArrayColumn<Bool> flags;
+    ScalarColumn<Double> times;
+    if (hasFlags) flags.attach(tab, "FLAG");
+    if (hasTimes) times.attach(tab, "TIME");
+    ArrayColumn<Complex> outData(outTab, "DATA");
+    ArrayColumn<Bool> outFlags;
+    ScalarColumn<Double> outTimes;
+    if (hasFlags) outFlags.attach(outTab, "FLAG");
+    if (hasTimes) outTimes.attach(outTab, "TIME");
+
+    auto readChunk = [&](ReduceChunk& chunk, int k) {
+        auto start = std::chrono::steady_clock::now();
+        Slicer rows(IPosition(1, (rownr_t)k * nTimes * args.nBls), IPosition(1, nTimes * args.nBls));
+        data.getColumnRange(rows, chunk.data, True);
+        if (hasFlags) flags.getColumnRange(rows, chunk.flags, True);
+        if (hasTimes) times.getColumnRange(rows, chunk.times, True);
+        stages.read += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    auto computeChunk = [&](ReduceChunk& chunk) {
+        auto start = std::chrono::steady_clock::now();
+        chunk.outData.resize(outShape);
+        Bool deleteData, deleteFlags = False, deleteOutData, deleteOutFlags = False;
+        const Complex* in = chunk.data.getStorage(deleteData);
+        const Bool* inFlags = hasFlags ? chunk.flags.getStorage(deleteFlags) : NULL;
+        Complex* out = chunk.outData.getStorage(deleteOutData);
+        Bool* outFlagValues = NULL;
+        if (hasFlags) {
+            chunk.outFlags.resize(outShape);
+            outFlagValues = chunk.outFlags.getStorage(deleteOutFlags);
+        }
+        average_chunk(in, inFlags, out, outFlagValues, args.nPols, args.nChs, args.nBls, nTimes, nAverage);
+        chunk.data.freeStorage(in, deleteData);
+        chunk.outData.putStorage(out, deleteOutData);
+        if (hasFlags) {
+            chunk.flags.freeStorage(inFlags, deleteFlags);
+            chunk.outFlags.putStorage(outFlagValues, deleteOutFlags);
+        }
+        if (hasTimes) {
+            chunk.outTimes.resize(args.nBls);
+            for (int bl = 0; bl < args.nBls; bl++) {
+                double total = 0;
+                for (int t = 0; t < nTimes; t++) total += chunk.times[t * args.nBls + bl];
+                chunk.outTimes[bl] = total / nTimes;
+            }
+        }
+        stages.compute += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    auto writeChunk = [&](ReduceChunk& chunk, int k) {
+        auto start = std::chrono::steady_clock::now();
+        Slicer rows(IPosition(1, (rownr_t)k * args.nBls), IPosition(1, args.nBls));
+        outData.putColumnRange(rows, chunk.outData);
+        if (hasFlags) outFlags.putColumnRange(rows, chunk.outFlags);
+        if (hasTimes) outTimes.putColumnRange(rows, chunk.outTimes);
+        stages.write += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    user_lock(tab, args, false, FileLocker::Read);
+    user_lock(outTab, args, false, FileLocker::Write);
+    auto start = std::chrono::steady_clock::now();
+    ReduceChunk chunks[2];
+    if (args.overlap && nChunks > 0) {
+        readChunk(chunks[0], 0);
+        for (int k = 0; k < nChunks; k++) {
+            ReduceChunk& current = chunks[k % 2];
+            ReduceChunk& other = chunks[(k + 1) % 2];
+            std::thread worker(computeChunk, std::ref(current));
+            if (k > 0) writeChunk(other, k - 1);
+            if (k + 1 < nChunks) readChunk(other, k + 1);
+            worker.join();
+        }
+        writeChunk(chunks[(nChunks - 1) % 2], nChunks - 1);
+    } else {
+        for (int k = 0; k < nChunks; k++) {
+            readChunk(chunks[0], k);
+            computeChunk(chunks[0]);
+            writeChunk(chunks[0], k);
+        }
+    }
+    stages.pipeline += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    user_unlock(outTab, args, false);
+    user_unlock(tab, args, false);
+}
+
+// Check the reduced table against a plain average of each output element's
+// unflagged inputs, read cell by cell, and of the timesteps' TIME.
+void check_reduced(const Table& tab, const Table& outTab, Args& args) {
+    int nTimes = args.averageTimes, nAverage = args.averageChannels;
+    bool hasFlags = tab.tableDesc().isColumn("FLAG");
+    bool hasTimes = tab.tableDesc().isColumn("TIME");
+    ArrayColumn<Complex> data(tab, "DATA"), outData(outTab, "DATA");
+    ArrayColumn<Bool> flags, outFlags;
+    ScalarColumn<Double> times, outTimes;
+    if (hasFlags) {
+        flags.attach(tab, "FLAG");
+        outFlags.attach(outTab, "FLAG");
+    }
+    if (hasTimes) {
+        times.attach(tab, "TIME");
+        outTimes.attach(outTab, "TIME");
+    }
+    for (rownr_t outRow = 0; outRow < outTab.nrow(); outRow++) {
+        rownr_t chunk = outRow / args.nBls, bl = outRow % args.nBls;
+        std::vector<Array<Complex>> cells;
+        std::vector<Array<Bool>> cellFlags;
+        double totalTime = 0;
+        for (int t = 0; t < nTimes; t++) {
+            rownr_t row = (chunk * nTimes + t) * args.nBls + bl;
+            cells.push_back(data(row));
+            if (hasFlags) cellFlags.push_back(flags(row));
+            if (hasTimes) totalTime += times(row);
+        }
+        Array<Complex> reduced = outData(outRow);
+        Array<Bool> reducedFlags;
+        if (hasFlags) reducedFlags = outFlags(outRow);
+        for (int pol = 0; pol < args.nPols; pol++) {
+            for (int out = 0; out < args.nChs / nAverage; out++) {
+                Complex sum(0, 0);
+                int count = 0;
+                for (int t = 0; t < nTimes; t++) {
+                    for (int ch = out * nAverage; ch < (out + 1) * nAverage; ch++) {
+                        IPosition element(2, pol, ch);
+                        if (hasFlags && cellFlags[t](element)) continue;
+                        sum += cells[t](element);
+                        count++;
+                    }
+                }
+                Complex expected = count > 0 ? sum / (float)count : Complex(0, 0);
+                IPosition element(2, pol, out);
+                bool flagMismatch = hasFlags && reducedFlags(element) != (count == 0);
+                if (flagMismatch || std::abs(reduced(element) - expected) > 1e-5 * std::max(1.0f, std::abs(expected))) {
+                    std::ostringstream errStream;
+                    errStream << "reduced DATA mismatch at row=" << outRow << ", pol=" << pol << ", channel=" << out \
+                        << ": " << reduced(element) << " != " << expected;
+                    throw std::runtime_error(errStream.str());
+                }
+            }
+        }
+        if (hasTimes && std::abs(outTimes(outRow) - totalTime / nTimes) > 1e-9) {
+            std::ostringstream errStream;
+            errStream << "reduced TIME mismatch at row=" << outRow << ": " << outTimes(outRow) << " != " << totalTime / nTimes;
+            throw std::runtime_error(errStream.str());
+        }
+    }
+}
+
+// Time the REDUCE pipeline into a reduced table, which is created before the
+// timed iterations. The rate is of the input, and a stages line has the time
+// of each stage.
+void bench_reduce(Table& tab, Args& args) {
+    Table outTab = create_reduced_table(tab, args);
+    int nTimes = args.averageTimes, nAverage = args.averageChannels;
+    bool hasFlags = tab.tableDesc().isColumn("FLAG");
+    int nChunks = args.nTimes / nTimes;
+    ReduceStages stages;
+    double inBytes = (double)args.nIters * nChunks * nTimes * args.nBls * args.nPols * args.nChs * (sizeof(Complex) + hasFlags);
+    double outBytes = (double)args.nIters * nChunks * args.nBls * args.nPols * (args.nChs / nAverage) * (sizeof(Complex) + hasFlags);
+    struct rusage usageBefore;
+    getrusage(RUSAGE_SELF, &usageBefore);
+    Timer timer;
+    for (int i = 0; i < args.nIters; i++) {
+        if (args.verbosity >= 0) {
+            cerr << "iteration " << i + 1 << " of " << args.nIters << "\r";
+        }
+        reduce_table(tab, outTab, stages, args);
+    }
+    if (args.nIters > 0) {
+        cerr << "                          \r";
+        report(timer, usageBefore, inBytes);
+        std::cout << "reduce: " << nTimes << " timesteps x " << nAverage << " channels, " \
+            << inBytes / (1024 * 1024) << " MiB in, " << outBytes / (1024 * 1024) << " MiB out" << endl;
+        std::cout << "stages: read " << stages.read << "s (" << inBytes / stages.read / (1024 * 1024) << " MiB/s), compute " \
+            << stages.compute << "s (" << inBytes / stages.compute / (1024 * 1024) << " MiB/s), write " << stages.write \
+            << "s (" << outBytes / stages.write / (1024 * 1024) << " MiB/s)";
+        if (args.overlap) {
+            std::cout << ", overlap hid " << stages.read + stages.compute + stages.write - stages.pipeline << "s";
+        }
+        std::cout << endl;
+    }
+}
+
+// Apply a 2x2 Jones matrix per channel of each antenna of a baseline to its
+// cells, V' = Ja V Jb^H, with the [XX, XY, YX, YY] correlations of a channel
+// as V and each matrix stored row-major. The products are written out per
+// element with no branches so that the compiler can vectorise the channels.
+void apply_jones(const Complex* data, Complex* corrected, const Complex* jonesA, const Complex* jonesB, int nChs) {
+    for (int ch = 0; ch < nChs; ch++) {
+        const Complex* v = data + 4 * ch;
+        const Complex* a = jonesA + 4 * ch;
+        const Complex* b = jonesB + 4 * ch;
+        Complex* out = corrected + 4 * ch;
+        // Ja V
+        Complex t00 = a[0] * v[0] + a[1] * v[2];
+        Complex t01 = a[0] * v[1] + a[1] * v[3];
+        Complex t10 = a[2] * v[0] + a[3] * v[2];
+        Complex t11 = a[2] * v[1] + a[3] * v[3];
+        // (Ja V) Jb^H
+        out[0] = t00 * std::conj(b[0]) + t01 * std::conj(b[1]);
+        out[1] = t00 * std::conj(b[2]) + t01 * std::conj(b[3]);
+        out[2] = t10 * std::conj(b[0]) + t11 * std::conj(b[1]);
+        out[3] = t10 * std::conj(b[2]) + t11 * std::conj(b[3]);
+    }
+}
+
+// APPLYCAL calibrates the 4 correlations of a COMPLEX DATA column
+void check_applycal(const Table& tab, Args& args) {
+    if (!tab.tableDesc().isColumn("DATA") || args.dataElement != ELEMENT_COMPLEX || args.nPols != 4) {
+        throw std::runtime_error("APPLYCAL needs a COMPLEX DATA column with 4 correlations");
+    }
+}
+
+// Jones matrices per antenna and channel, row-major. The synthetic gains are
+// near unity and differ per antenna and channel, the others are identity.
+std::vector<Complex> make_jones(bool synthetic, Args& args) {
+    int nAnts = baseline_antennas(args);
+    std::vector<Complex> jones((size_t)nAnts * args.nChs * 4);
+    for (int ant = 0; ant < nAnts; ant++) {
+        for (int ch = 0; ch < args.nChs; ch++) {
+            Complex* j = &jones[((size_t)ant * args.nChs + ch) * 4];
+            if (synthetic) {
+                j[0] = Complex(1 + 0.01 * ant, 0.001 * ch);
+                j[1] = Complex(0.01, -0.001 * ant);
+                j[2] = Complex(-0.01, 0.001 * ant);
+                j[3] = Complex(1 - 0.01 * ant, -0.001 * ch);
+            } else {
+                j[0] = j[3] = Complex(1, 0);
+                j[1] = j[2] = Complex(0, 0);
+            }
+        }
+    }
+    return jones;
+}
+
+// the real time of reading, applying the Jones matrices and writing
+struct ApplycalStages {
+    double read = 0;
+    double compute = 0;
+    double write = 0;
+};
+
+// Calibrate the table the way applycal does: read DATA a timestep of rows at
+// a time, apply the Jones matrices of each baseline's antennas per channel,
+// and write CORRECTED_DATA, timing each stage.
+void applycal_table(Table& tab, const std::vector<Complex>& jones, ApplycalStages& stages, Args& args) {
+    std::vector<int> antennas1(args.nBls), antennas2(args.nBls);
+    for (int bl = 0; bl < args.nBls; bl++) {
+        antennas1[bl] = baseline_antenna_pair(bl, antennas2[bl], args);
+    }
+    ArrayColumn<Complex> data(tab, "DATA");
+    ArrayColumn<Complex> correctedData(tab, "CORRECTED_DATA");
+    Array<Complex> values, corrected(IPosition(3, args.nPols, args.nChs, args.nBls));
+    user_lock(tab, args, false, FileLocker::Write);
+    for (int t = 0; t < args.nTimes; t++) {
+        auto start = std::chrono::steady_clock::now();
+        get_timestep(data, t, values, args);
+        auto readDone = std::chrono::steady_clock::now();
+        Bool deleteIn, deleteOut;
+        const Complex* in = values.getStorage(deleteIn);
+        Complex* out = corrected.getStorage(deleteOut);
+        size_t cellSize = (size_t)args.nPols * args.nChs;
+        for (int bl = 0; bl < args.nBls; bl++) {
+            apply_jones(in + bl * cellSize, out + bl * cellSize, &jones[(size_t)antennas1[bl] * args.nChs * 4],
+                &jones[(size_t)antennas2[bl] * args.nChs * 4], args.nChs);
+        }
+        values.freeStorage(in, deleteIn);
+        corrected.putStorage(out, deleteOut);
+        auto computed = std::chrono::steady_clock::now();
+        if (args.rowOrder == ORDER_TIME) {
+            correctedData.putColumnRange(Slicer(IPosition(1, t * args.nBls), IPosition(1, args.nBls)), corrected);
+        } else {
+            correctedData.putColumnCells(timestep_rows(t, args), corrected);
+        }
+        auto written = std::chrono::steady_clock::now();
+        stages.read += std::chrono::duration<double>(readDone - start).count();
+        stages.compute += std::chrono::duration<double>(computed - readDone).count();
+        stages.write += std::chrono::duration<double>(written - computed).count();
+    }
+    user_unlock(tab, args, false);
+}
+
+// Check CORRECTED_DATA against Ja V Jb^H computed cell by cell as a plain
+// matrix product of each channel's correlations.
+void check_corrected(const Table& tab, const std::vector<Complex>& jones, Args& args) {
+    ArrayColumn<Complex> data(tab, "DATA");
+    ArrayColumn<Complex> correctedData(tab, "CORRECTED_DATA");
+    for (int i = 0; i < args.nTimes * args.nBls; i++) {
+        int antenna2;
+        int antenna1 = baseline_antenna_pair(i % args.nBls, antenna2, args);
+        rownr_t row = table_row(i, args);
+        Array<Complex> cell = data(row), corrected = correctedData(row);
+        for (int ch = 0; ch < args.nChs; ch++) {
+            const Complex* a = &jones[((size_t)antenna1 * args.nChs + ch) * 4];
+            const Complex* b = &jones[((size_t)antenna2 * args.nChs + ch) * 4];
+            for (int r = 0; r < 2; r++) {
+                for (int c = 0; c < 2; c++) {
+                    Complex expected(0, 0);
+                    for (int k = 0; k < 2; k++) {
+                        for (int l = 0; l < 2; l++) {
+                            expected += a[r * 2 + k] * cell(IPosition(2, k * 2 + l, ch)) * std::conj(b[c * 2 + l]);
+                        }
+                    }
+                    Complex value = corrected(IPosition(2, r * 2 + c, ch));
+                    if (std::abs(value - expected) > 1e-5 * std::max(1.0f, std::abs(expected))) {
+                        std::ostringstream errStream;
+                        errStream << "CORRECTED_DATA mismatch at row=" << row << ", pol=" << r * 2 + c << ", channel=" << ch \
+                            << ": " << value << " != " << expected;
+                        throw std::runtime_error(errStream.str());
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Time applycal_table with synthetic gains. CORRECTED_DATA is part of the
+// table from the fill, or with --add-column added afterwards with
+// Table::addColumn (timed on its own). Reports the rate of DATA and the split
+// between I/O and compute.
+void bench_applycal(Table& tab, Args& args) {
+    check_applycal(tab, args);
+    if (args.addCorrected) {
+        Timer timer;
+        add_column(tab, "CORRECTED_DATA", IPosition(2, args.nPols, args.nChs), args);
+        std::cout << "addColumn: " << timer.real() << "s" << endl;
+    }
+    std::vector<Complex> jones = make_jones(true, args);
+    ApplycalStages stages;
+    struct rusage usageBefore;
+    getrusage(RUSAGE_SELF, &usageBefore);
+    Timer timer;
+    for (int i = 0; i < args.nIters; i++) {
+        if (args.verbosity >= 0) {
+            cerr << "iteration " << i + 1 << " of " << args.nIters << "\r";
+        }
+        applycal_table(tab, jones, stages, args);
+    }
+    if (args.nIters > 0) {
+        cerr << "                          \r";
+        double nBytes = (double)args.nIters * args.nTimes * args.nBls * args.nPols * args.nChs * sizeof(Complex);
+        report(timer, usageBefore, nBytes);
+        double total = stages.read + stages.compute + stages.write;
+        std::cout << "applycal: read " << stages.read << "s, write " << stages.write << "s, compute " << stages.compute \
+            << "s (" << 100 * (stages.read + stages.write) / total << "% I/O, " << 100 * stages.compute / total << "% compute)" << endl;
+    }
+}
+
+// Describe columns of an existing table (all of them if names is empty) with
+// the fixed shape of their first cell and no data manager, so that a new
+// table made from it is bound by bind_columns like the synthetic table.
+TableDesc portable_desc(const Table& source, const std::vector<String>& names) {
+    const TableDesc& sourceDesc = source.tableDesc();
+    TableDesc td("tPortableDesc", "1", TableDesc::Scratch);
+    for (uInt i = 0; i < sourceDesc.ncolumn(); i++) {
+        ColumnDesc colDesc(sourceDesc.columnDesc(i));
+        String name = colDesc.name();
+        if (!names.empty() && std::find(names.begin(), names.end(), name) == names.end()) continue;
+        if (colDesc.isArray()) {
+            TableColumn sourceCol(source, name);
+            if (source.nrow() == 0 || !sourceCol.isDefined(0)) {
+                cerr << "warning: skipping " << name << ", its first cell is undefined" << endl;
+                continue;
+            }
+            colDesc.setShape(sourceCol.shape(0));
+        }
+        colDesc.dataManagerType() = "StandardStMan";
+        colDesc.dataManagerGroup() = "StandardStMan";
+        td.addColumn(colDesc);
+    }
+    return td;
+}
+
+// One column replayed from an existing table: a chunk of rows is read from
+// the source into a reused buffer, then written to the new table with the
+// write mode.
+class ReplayColumn {
+  public:
+    virtual ~ReplayColumn() {}
+    // read rows from the source into the buffer, returns the bytes read
+    virtual long long read(const Slicer& rows) = 0;
+    // write the buffer to the rows starting at start
+    virtual void write(rownr_t start, WriteMode writeMode) = 0;
+};
+
+template <typename T>
+class ScalarReplayColumn : public ReplayColumn {
+  public:
+    ScalarReplayColumn(const Table& source, Table& target, const String& name)
+        : sourceCol(source, name), targetCol(target, name) {}
+    long long read(const Slicer& rows) {
+        sourceCol.getColumnRange(rows, buffer, True);
+        return buffer.nelements() * sizeof(T);
+    }
+    void write(rownr_t start, WriteMode writeMode) {
+        rownr_t nRows = buffer.nelements();
+        switch (writeMode) {
+            case CELL:
+                for (rownr_t i = 0; i < nRows; i++) {
+                    targetCol.put(start + i, buffer[i]);
+                }
+                break;
+            case CELLS:
+                targetCol.putColumnCells(RefRows(start, start + nRows - 1), buffer);
+                break;
+            case COLUMN:
+                targetCol.putColumn(buffer);
+                break;
+        }
+    }
+  private:
+    ScalarColumn<T> sourceCol;
+    ScalarColumn<T> targetCol;
+    Vector<T> buffer;
+};
+
+template <typename T>
+class ArrayReplayColumn : public ReplayColumn {
+  public:
+    ArrayReplayColumn(const Table& source, Table& target, const String& name)
+        : sourceCol(source, name), targetCol(target, name) {}
+    long long read(const Slicer& rows) {
+        sourceCol.getColumnRange(rows, buffer, True);
+        return buffer.nelements() * sizeof(T);
+    }
+    void write(rownr_t start, WriteMode writeMode) {
+        IPosition shape = buffer.shape();
+        size_t rowAxis = shape.size() - 1;
+        rownr_t nRows = shape[rowAxis];
+        switch (writeMode) {
+            case CELL:
+                for (rownr_t i = 0; i < nRows; i++) {
+                    IPosition first(shape.size(), 0);
+                    IPosition last(shape - 1);
+                    first[rowAxis] = i;
+                    last[rowAxis] = i;
+                    targetCol.put(start + i, buffer(first, last).nonDegenerate(rowAxis));
+                }
+                break;
+            case CELLS:
+                targetCol.putColumnCells(RefRows(start, start + nRows - 1), buffer);
+                break;
+            case COLUMN:
+                targetCol.putColumn(buffer);
+                break;
+        }
+    }
+  private:
+    ArrayColumn<T> sourceCol;
+    ArrayColumn<T> targetCol;
+    Array<T> buffer;
+};
+
+// the data types make_replay_column can replay
+bool replay_supported(DataType dataType) {
+    switch (dataType) {
+        case TpBool: case TpInt: case TpFloat: case TpDouble: case TpComplex: case TpDComplex:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// make a replay column for the data type of a column
+template <template <typename> class C>
+std::unique_ptr<ReplayColumn> make_replay_column(DataType dataType, const Table& source, Table& target, const String& name) {
+    switch (dataType) {
+        case TpBool: return std::unique_ptr<ReplayColumn>(new C<Bool>(source, target, name));
+        case TpInt: return std::unique_ptr<ReplayColumn>(new C<Int>(source, target, name));
+        case TpFloat: return std::unique_ptr<ReplayColumn>(new C<Float>(source, target, name));
+        case TpDouble: return std::unique_ptr<ReplayColumn>(new C<Double>(source, target, name));
+        case TpComplex: return std::unique_ptr<ReplayColumn>(new C<Complex>(source, target, name));
+        case TpDComplex: return std::unique_ptr<ReplayColumn>(new C<DComplex>(source, target, name));
+        default: throw std::runtime_error("can't replay the data type of " + name);
+    }
+}
+
+// Replay a real MeasurementSet: read TIME, UVW and DATA (or every column with
+// --replay-all) from it one timestep at a time, and write them into a new
+// table with the storage options and write mode. Reading and writing are
+// timed separately. Columns with varying cell shapes can't be replayed, see
+// portable_desc.
+void bench_replay(const String& tableName, Args& args) {
+    Table source(args.replayName);
+    const TableDesc& sourceDesc = source.tableDesc();
+    rownr_t nRows = source.nrow();
+    if (nRows == 0 || !sourceDesc.isColumn("TIME")) {
+        throw std::runtime_error("replay needs a table with rows and a TIME column: " + args.replayName);
+    }
+
+    // a timestep is a run of rows with the same TIME
+    Vector<Double> sourceTimes = ScalarColumn<Double>(source, "TIME").getColumn();
+    std::vector<rownr_t> timestepStarts;
+    for (rownr_t i = 0; i < nRows; i++) {
+        if (i == 0 || sourceTimes[i] != sourceTimes[i - 1]) {
+            timestepStarts.push_back(i);
+        }
+    }
+    timestepStarts.push_back(nRows);
+    args.nTimes = timestepStarts.size() - 1;
+    args.nBls = nRows / args.nTimes;
+
+    std::vector<String> names;
+    if (!args.replayAll) {
+        names = {"TIME", "UVW", "DATA"};
+    }
+    // leave out the columns of types that can't be replayed before making the table
+    TableDesc portableDesc = portable_desc(source, names);
+    TableDesc td("tReplayDesc", "1", TableDesc::Scratch);
+    for (uInt i = 0; i < portableDesc.ncolumn(); i++) {
+        const ColumnDesc& colDesc = portableDesc.columnDesc(i);
+        if (replay_supported(colDesc.dataType())) {
+            td.addColumn(colDesc);
+        } else {
+            cerr << "warning: skipping " << colDesc.name() << ", its data type is not supported" << endl;
+        }
+    }
+    if (td.isColumn("DATA")) {
+        IPosition dataShape = td.columnDesc("DATA").shape();
+        args.nPols = dataShape[0];
+        args.nChs = dataShape[1];
+    }
+    if (args.verbosity >= 0) {
+        cout << "# replaying " << args.replayName << ": " << nRows << " rows, " << args.nTimes << " timesteps, " \
+            << td.ncolumn() << " columns" << endl;
+    }
+
+    Table target = create_table(tableName, td, nRows, args);
+    std::vector<std::unique_ptr<ReplayColumn>> columns;
+    for (uInt i = 0; i < td.ncolumn(); i++) {
+        const ColumnDesc& colDesc = td.columnDesc(i);
+        columns.push_back(colDesc.isArray()
+            ? make_replay_column<ArrayReplayColumn>(colDesc.dataType(), source, target, colDesc.name())
+            : make_replay_column<ScalarReplayColumn>(colDesc.dataType(), source, target, colDesc.name()));
+    }
+
+    double readTime = 0;
+    double writeTime = 0;
+    long long nBytes = 0;
+    struct rusage usageBefore;
+    getrusage(RUSAGE_SELF, &usageBefore);
+    Timer timer;
+    for (int i = 0; i < args.nIters; i++) {
+        if (args.verbosity >= 0) {
+            cerr << "iteration " << i + 1 << " of " << args.nIters << "\r";
+        }
+        user_lock(target, args, false, FileLocker::Write);
+        // COLUMN mode replays the whole table as a single chunk
+        int nChunks = args.writeMode == COLUMN ? 1 : args.nTimes;
+        for (int t = 0; t < nChunks; t++) {
+            rownr_t start = args.writeMode == COLUMN ? 0 : timestepStarts[t];
+            rownr_t end = args.writeMode == COLUMN ? nRows : timestepStarts[t + 1];
+            Slicer rows(IPosition(1, start), IPosition(1, end - start));
+            user_lock(target, args, true, FileLocker::Write);
+            auto readStart = std::chrono::steady_clock::now();
+            for (auto& column : columns) {
+                nBytes += column->read(rows);
+            }
+            auto writeStart = std::chrono::steady_clock::now();
+            for (auto& column : columns) {
+                column->write(start, args.writeMode);
+            }
+            auto writeEnd = std::chrono::steady_clock::now();
+            user_unlock(target, args, true);
+            readTime += std::chrono::duration<double>(writeStart - readStart).count();
+            writeTime += std::chrono::duration<double>(writeEnd - writeStart).count();
+        }
+        user_unlock(target, args, false);
+    }
+    if (args.nIters > 0) {
+        cerr << "                          \r";
+        report(timer, usageBefore, nBytes);
+        std::cout << "read:   " << readTime << "s, " << nBytes / readTime / (1024 * 1024) << " MiB/s" << endl;
+        std::cout << "write:  " << writeTime << "s, " << nBytes / writeTime / (1024 * 1024) << " MiB/s" << endl;
+    }
+}
+
+// bytes in one row of any table, from the shapes of its columns
+long long table_row_bytes(const Table& tab) {
+    long long nBytes = 0;
+    const TableDesc& desc = tab.tableDesc();
+    for (uInt i = 0; i < desc.ncolumn(); i++) {
+        const ColumnDesc& colDesc = desc.columnDesc(i);
+        long long cellBytes = ValType::getTypeSize(colDesc.dataType());
+        if (colDesc.isArray()) {
+            if (colDesc.isFixedShape()) {
+                cellBytes *= colDesc.shape().product();
+            } else if (tab.nrow() > 0) {
+                cellBytes *= TableColumn(tab, colDesc.name()).shape(0).product();
             }
-            break;
-        case COLUMN:
-            throw std::runtime_error("can't write rowwise in COLUMN mode");
+        }
+        nBytes += cellBytes;
     }
+    return nBytes;
 }
 
-void compare_time_col(Table& tab, Vector<Double>& times, Args& args) {
-    ScalarColumn<Double> timeCol(tab, "TIME");
-    for (int i = 0; i < (args.nTimes * args.nBls); i++) {
-        if (timeCol(i) != times[i]) {
-            std::ostringstream errStream;
-            errStream << "time mismatch in " << tab.tableName() << " at row=" << i << ": " << timeCol(i) << " != " << times[i];
-            throw std::runtime_error(errStream.str());
+// read every baseline across all timesteps, the way fringe fitting and RFI
+// tools do, with getColumnCells on the strided rows of each baseline.
+void bench_baselines(Table& tab, Workloads& columns, Args& args) {
+    std::vector<double> latencies;
+    struct rusage usageBefore;
+    getrusage(RUSAGE_SELF, &usageBefore);
+    Timer timer;
+    for (int i = 0; i < args.nIters; i++) {
+        if (args.verbosity >= 0) {
+            cerr << "iteration " << i + 1 << " of " << args.nIters << "\r";
+        }
+        user_lock(tab, args, false, FileLocker::Read);
+        for (auto& column : columns) {
+            column->attach(tab);
+        }
+        for (int bl = 0; bl < args.nBls; bl++) {
+            auto start = std::chrono::steady_clock::now();
+            RefRows rownrs = baseline_rows(bl, args);
+            for (auto& column : columns) {
+                column->getCells(rownrs);
+            }
+            latencies.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        user_unlock(tab, args, false);
+    }
+    if (args.nIters > 0) {
+        cerr << "                          \r";
+        report(timer, usageBefore, (double)args.nIters * args.nTimes * args.nBls * row_bytes(columns));
+        report_latency("baseline", latencies);
+        if (has_flags(args)) {
+            report_flag_conversion(args, timer.user());
         }
     }
 }
 
-void compare_uvw_col(Table& tab, Array<Float>& uvws, Args& args) {
-    IPosition shape = uvws.shape();
-    ArrayColumn<Float> uvwCol(tab, "UVW");
-    Array<Float> uvwValues = uvwCol.getColumn();
-    if (shape != uvwValues.shape()) {
-        std::ostringstream errStream;
-        errStream << "uvw shape mismatch in " << tab.tableName();
-        throw ArrayShapeError(shape, uvwValues.shape(), errStream.str().c_str());
+// Convert a table into the selected storage manager layout, the way Cotter
+// and Birli output is converted from StandardStMan into a tiled or compressed
+// layout. Three strategies are timed:
+// - COLUMNS: TableCopy::copyColumnData into a new table one column at a time,
+//   reporting the throughput of each column
+// - ROWS: TableCopy::copyRows into the same new table
+// - DEEPCOPY: Table::deepCopy with the data manager info of the new table
+void bench_copy(Table& source, Args& args) {
+    String copyName("/tmp/table.copy/");
+    String deepCopyName("/tmp/table.deepcopy/");
+    TableDesc td = portable_desc(source, std::vector<String>());
+    rownr_t nRows = source.nrow();
+    Table target = create_table(copyName, td, nRows, args);
+    long long rowBytes = table_row_bytes(target);
+
+    std::cout << "## copy: COLUMNS" << endl;
+    struct rusage usageBefore;
+    getrusage(RUSAGE_SELF, &usageBefore);
+    Timer timer;
+    for (uInt i = 0; i < td.ncolumn(); i++) {
+        const ColumnDesc& colDesc = td.columnDesc(i);
+        long long cellBytes = ValType::getTypeSize(colDesc.dataType());
+        if (colDesc.isArray()) cellBytes *= colDesc.shape().product();
+        Timer columnTimer;
+        for (int iter = 0; iter < args.nIters; iter++) {
+            user_lock(target, args, false, FileLocker::Write);
+            TableCopy::copyColumnData(source, colDesc.name(), target, colDesc.name());
+            user_unlock(target, args, false);
+        }
+        std::cout << "column " << colDesc.name() << ": " << columnTimer.real() << "s, " \
+            << (double)args.nIters * nRows * cellBytes / columnTimer.real() / (1024 * 1024) << " MiB/s" << endl;
     }
-    for( int i = 0; (rownr_t)i < (uvwCol.nrow()); i++ ) {
-        Array<Float> actual = uvwCol(i);
-        if (args.verbosity > 0) {
-            std::cout << "actual: " << actual << endl;
+    report(timer, usageBefore, (double)args.nIters * nRows * rowBytes);
+
+    std::cout << "## copy: ROWS" << endl;
+    getrusage(RUSAGE_SELF, &usageBefore);
+    timer.mark();
+    for (int iter = 0; iter < args.nIters; iter++) {
+        user_lock(target, args, false, FileLocker::Write);
+        TableCopy::copyRows(target, source);
+        user_unlock(target, args, false);
+    }
+    report(timer, usageBefore, (double)args.nIters * nRows * rowBytes);
+
+    Record dminfo = target.dataManagerInfo();
+    target = Table();
+    std::cout << "## copy: DEEPCOPY" << endl;
+    if (args.tsmMode != DEFAULT_TSMMODE) {
+        // the deep copy is written through its own table, opened with the aipsrc option
+        cerr << "warning: Table::deepCopy takes no TSMOption, -M only applies to COLUMNS and ROWS" << endl;
+    }
+    getrusage(RUSAGE_SELF, &usageBefore);
+    timer.mark();
+    for (int iter = 0; iter < args.nIters; iter++) {
+        // valueCopy so that the data is rewritten with the new data managers
+        source.deepCopy(deepCopyName, dminfo, StorageOption(storageOptions[args.storageMode], args.blockSize),
+            Table::New, True, endianFormats[args.endianMode]);
+    }
+    report(timer, usageBefore, (double)args.nIters * nRows * rowBytes);
+}
+
+// the TaQL statements run in QUERY mode, from -Q or a default set of time
+// range, per baseline, aggregate, sort and update queries.
+std::vector<std::string> load_queries(Args& args) {
+    std::vector<std::string> queries;
+    if (args.queryFile.empty()) {
+        std::ostringstream baseline;
+        if (args.rowOrder == ORDER_TIME) {
+            baseline << "SELECT FROM $1 WHERE ROWID() % " << args.nBls << " == " << args.nBls / 2;
+        } else {
+            baseline << "SELECT FROM $1 WHERE ROWID() / " << args.nTimes << " == " << args.nBls / 2;
         }
-        // Array<Float> expected = uvwIter.array();
-        Array<Float> expected = uvws(Slicer(IPosition(2, 0, i), IPosition(2, Slicer::MimicSource, 1)));
-        expected.removeDegenerate();
-        // check the sizes are the same
-        if (actual.shape() != expected.shape()) {
-            std::ostringstream errStream;
-            errStream << "uvw shape mismatch in " << tab.tableName() << " at row=" << i;
-            throw ArrayShapeError(actual.shape(), expected.shape(), errStream.str().c_str());
+        queries.push_back("SELECT FROM $1 WHERE TIME BETWEEN 2 AND 5");
+        queries.push_back(baseline.str());
+        queries.push_back("SELECT TIME, GMEAN(DATA) AS MEAN FROM $1 GROUPBY TIME");
+        queries.push_back("SELECT TIME, GSUM(DATA) AS SUM FROM $1 GROUPBY TIME");
+        queries.push_back("SELECT FROM $1 ORDERBY DESC TIME");
+        // the updates are idempotent, so every iteration does the same work
+        queries.push_back("UPDATE $1 SET UVW=ABS(UVW) WHERE TIME < 1");
+        if (has_flags(args)) {
+            queries.push_back("SELECT FROM $1 WHERE ANY(FLAG)");
+            queries.push_back("UPDATE $1 SET FLAG=T WHERE TIME < 1");
         }
-        // check the values are the same
-        for (int j = 0; j < shape[0]; j++) {
-            IPosition index(1, j);
-            if (actual(index) !=  expected(index)) {
-                std::ostringstream errStream;
-                errStream << "uvw value mismatch in " << tab.tableName() << " at row=" << i << ", [" << j << "]: " \
-                    << actual(index) << " != " << expected(index) << " (delta=" << fabs(actual(index)-expected(index)) << ")";
-                throw std::runtime_error(errStream.str());
-            } else if (args.verbosity > 0) {
-                std::cout << "uvw value match in " << tab.tableName() << " at row=" << i << ", [" << j << "]: " \
-                    << actual(index) << " == " << expected(index) << endl;
+        return queries;
+    }
+    std::ifstream file(args.queryFile.c_str());
+    if (!file) {
+        throw std::runtime_error("could not open query file " + args.queryFile);
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] == '#') continue;
+        queries.push_back(line.substr(start));
+    }
+    return queries;
+}
+
+// whether a TaQL statement changes the table rather than only selecting from it
+bool modifies_table(const std::string& query) {
+    std::istringstream words(query);
+    std::string command;
+    words >> command;
+    if (command == "TIME" || command == "time") words >> command;
+    std::transform(command.begin(), command.end(), command.begin(), ::toupper);
+    return command == "UPDATE" || command == "INSERT" || command == "DELETE" || command == "ALTER" \
+        || command == "CREATE" || command == "DROP";
+}
+
+// run each TaQL statement through tableCommand against the table. The parse
+// is timed on its own with TaQLNode::parse, and the plan and execution time
+// is that of tableCommand less the parse time, since tableCommand parses the
+// statement again. With -v the statement is prefixed with TIME so that
+// casacore prints its own breakdown of the parse, plan and execution steps.
+// The rate is in rows of the result, since a selection is a reference table
+// that reads only the columns the statement uses; an io line has the bytes
+// read per iteration from /proc/self/io. Selections take a read lock, the
+// statements that change the table a write lock.
+void bench_queries(Table& tab, Args& args) {
+    std::vector<std::string> queries = load_queries(args);
+    for (const std::string& query : queries) {
+        String command(args.verbosity > 0 ? "TIME " + query : query);
+        FileLocker::LockType lockType = modifies_table(query) ? FileLocker::Write : FileLocker::Read;
+        double parseTime = 0;
+        double execTime = 0;
+        rownr_t nRows = 0;
+        long long rcharTotal = 0, readBytesTotal = 0;
+        for (int i = 0; i < args.nIters; i++) {
+            user_lock(tab, args, false, lockType);
+            Timer timer;
+            TaQLNode::parse(command);
+            parseTime += timer.real();
+            long long rcharBefore, readBytesBefore;
+            io_counters(rcharBefore, readBytesBefore);
+            timer.mark();
+            TaQLResult result = tableCommand(command, tab);
+            execTime += timer.real();
+            long long rchar, readBytes;
+            io_counters(rchar, readBytes);
+            rcharTotal += rchar - rcharBefore;
+            readBytesTotal += readBytes - readBytesBefore;
+            if (result.isTable()) {
+                Table resultTable = result.table();
+                nRows = resultTable.nrow();
             }
+            user_unlock(tab, args, false);
         }
+        // tableCommand parses again, leave that out of the plan and execution time
+        double planExecTime = std::max(0.0, execTime - parseTime);
+        std::cout << "## query: " << query << endl;
+        std::cout << "parse:  " << parseTime / args.nIters << "s" << endl;
+        std::cout << "exec:   " << planExecTime / args.nIters << "s (plan and execute, tableCommand less parse)" << endl;
+        std::cout << "rows:   " << nRows << endl;
+        std::cout << "rate:   " << nRows * args.nIters / planExecTime << " rows/s" << endl;
+        std::cout << "io:     " << readBytesTotal / (1024.0 * 1024) / args.nIters << " MiB read_bytes, " \
+            << rcharTotal / (1024.0 * 1024) / args.nIters << " MiB rchar per iteration" << endl;
     }
 }
 
-// check the values in the data col match the data array
-void compare_data_col(Table& tab, Array<Complex>& data, Args& args) {
-    IPosition shape = data.shape();
-    ArrayColumn<Complex> dataCol(tab, "DATA");
-    Array<Complex> dataValues = dataCol.getColumn();
-    if (shape != dataValues.shape()) {
-        std::ostringstream errStream;
-        errStream << "data shape mismatch in " << tab.tableName();
-        throw ArrayShapeError(shape, dataValues.shape(), errStream.str().c_str());
+// Background load on the table's filesystem and the CPUs, from construction
+// until destruction, the way flagging and a quick-look imager share an ingest
+// node with the writer:
+// - SEQUENTIAL: 1 MiB writes through a file next to the table, wrapping at
+//   IO_FILE_BYTES, each synced so that it reaches the device
+// - RANDOM: synced 64 KiB writes at random offsets in the same file
+// both paced to ioRate MiB/s (0 for as fast as possible), and on cpuThreads
+// threads:
+// - COMPUTE: a dependent chain of floating point operations in registers
+// - MEMORY: a triad over CPU_BUFFER_BYTES, larger than the last level cache
+// The load the threads achieved is printed when they are stopped.
+class Interference {
+  public:
+    Interference(const std::string& path, Args& args) : path(path), args(args) {
+        start = std::chrono::steady_clock::now();
+        if (args.ioLoad != IOLOAD_NONE) {
+            threads.push_back(std::thread(&Interference::io_load, this));
+        }
+        if (args.cpuLoad != CPULOAD_NONE) {
+            for (int i = 0; i < args.cpuThreads; i++) {
+                threads.push_back(std::thread(&Interference::cpu_load, this));
+            }
+        }
     }
-    for( int i = 0; (rownr_t)i < (dataCol.nrow()); i++ ) {
-        Array<Complex> actual = dataCol(i);
-        if (args.verbosity > 0) {
-            std::cout << "actual: " << actual << endl;
+    ~Interference() {
+        if (threads.empty()) return;
+        stopping = true;
+        for (std::thread& thread : threads) {
+            thread.join();
         }
-        // Array<Complex> expected = uvwIter.array();
-        Array<Complex> expected = data(Slicer(IPosition(3, 0, 0, i), IPosition(3, Slicer::MimicSource, Slicer::MimicSource, 1)));
-        expected.removeDegenerate();
-        // check the sizes are the same
-        if (actual.shape() != expected.shape()) {
-            std::ostringstream errStream;
-            errStream << "data shape mismatch in " << tab.tableName() << " at row=" << i;
-            throw ArrayShapeError(actual.shape(), expected.shape(), errStream.str().c_str());
-        }
-        // check the values are the same
-        for (int j = 0; j < shape[1]; j++) {
-            for (int k = 0; k < shape[0]; k++) {
-                IPosition index(2, k, j);
-                if (actual(index) !=  expected(index)) {
-                    std::ostringstream errStream;
-                    errStream << "data value mismatch in " << tab.tableName() << " at row=" << i << ", [" << j << ", " << k << "]: " \
-                        << actual(index) << " != " << expected(index) << " (delta=" << fabs(actual(index)-expected(index)) << ")";
-                    throw std::runtime_error(errStream.str());
-                } else if (args.verbosity > 0) {
-                    std::cout << "data value match in " << tab.tableName() << " at row=" << i << ", [" << j << ", " << k << "]: " \
-                        << actual(index) << " == " << expected(index) << endl;
+        unlink(path.c_str());
+        report();
+    }
+  private:
+    void report() {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "interference:";
+        if (args.ioLoad != IOLOAD_NONE) {
+            std::cout << " io=" << ioLoadNames[args.ioLoad] << " " << ioBytes / seconds / (1024 * 1024) << " MiB/s";
+            if (ioError != 0) {
+                std::cout << " (failed: " << strerror(ioError) << ")";
+            }
+        }
+        if (args.cpuLoad != CPULOAD_NONE) {
+            std::cout << " cpu=" << cpuLoadNames[args.cpuLoad] << " on " << args.cpuThreads << " threads, " \
+                << cpuBytes / seconds / (1024 * 1024 * 1024) << " GiB/s";
+        }
+        std::cout << endl;
+    }
+    void io_load() {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+        if (fd < 0) {
+            ioError = errno;
+            return;
+        }
+        long long blockBytes = args.ioLoad == IOLOAD_SEQUENTIAL ? 1024 * 1024 : 64 * 1024;
+        std::vector<char> block(blockBytes, 'x');
+        std::mt19937_64 random(1);
+        long long offset = 0;
+        while (!stopping) {
+            if (args.ioLoad == IOLOAD_RANDOM) {
+                offset = random() % (IO_FILE_BYTES / blockBytes) * blockBytes;
+            }
+            if (pwrite(fd, block.data(), blockBytes, offset) != blockBytes || fdatasync(fd) != 0) {
+                ioError = errno;
+                break;
+            }
+            offset = (offset + blockBytes) % IO_FILE_BYTES;
+            ioBytes += blockBytes;
+            if (args.ioRate > 0) {
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(ioBytes / (args.ioRate * 1024 * 1024))));
+            }
+        }
+        close(fd);
+    }
+    void cpu_load() {
+        if (args.cpuLoad == CPULOAD_COMPUTE) {
+            double x = 1.0;
+            while (!stopping) {
+                for (int i = 0; i < 1000000; i++) {
+                    x = x * 1.0000001 + 1e-9;
                 }
+                // count the operand bytes of the multiply-adds
+                cpuBytes += 1000000LL * sizeof(double);
             }
+            volatile double sink = x;
+            (void)sink;
+            return;
+        }
+        size_t n = CPU_BUFFER_BYTES / (3 * sizeof(double));
+        std::vector<double> a(n, 1.0), b(n, 2.0), c(n, 3.0);
+        while (!stopping) {
+            for (size_t i = 0; i < n; i++) {
+                a[i] = b[i] + 0.5 * c[i];
+            }
+            cpuBytes += 3LL * n * sizeof(double);
         }
     }
-}
+    const std::string path;
+    Args& args;
+    std::chrono::steady_clock::time_point start;
+    std::vector<std::thread> threads;
+    std::atomic<bool> stopping{false};
+    std::atomic<long long> ioBytes{0};
+    std::atomic<long long> cpuBytes{0};
+    std::atomic<int> ioError{0};
+};
 
 int main(int argc, char const *argv[])
 {
@@ -515,6 +2957,97 @@ int main(int argc, char const *argv[])
         // printf("arg %d: %s\n", argi, argv[argi]);
         if(argv[argi][0] == '-') {
             switch(argv[argi][1]) {
+                case '-':
+                    if (std::string(argv[argi]) == "--replay") {
+                        if (++argi < argc) {
+                            args.replayName = argv[argi];
+                        } else {
+                            usage(argv);
+                            throw std::runtime_error("missing replay argument");
+                        }
+                    } else if (std::string(argv[argi]) == "--replay-all") {
+                        args.replayAll = true;
+                    } else if (std::string(argv[argi]) == "--results") {
+                        if (++argi < argc) {
+                            args.resultsName = argv[argi];
+                        } else {
+                            usage(argv);
+                            throw std::runtime_error("missing results argument");
+                        }
+                    } else if (std::string(argv[argi]) == "--cadence") {
+                        if (++argi < argc) {
+                            args.cadence = atof(argv[argi]);
+                        } else {
+                            usage(argv);
+                            throw std::runtime_error("missing cadence argument");
+                        }
+                    } else if (std::string(argv[argi]) == "--io-rate") {
+                        if (++argi < argc) {
+                            args.ioRate = atof(argv[argi]);
+                        } else {
+                            usage(argv);
+                            throw std::runtime_error("missing io rate argument");
+                        }
+                    } else if (std::string(argv[argi]) == "--reads") {
+                        if (++argi < argc) {
+                            args.nReads = atoi(argv[argi]);
+                        } else {
+                            usage(argv);
+                            throw std::runtime_error("missing reads argument");
+                        }
+                    } else if (std::string(argv[argi]) == "--read-channels") {
+                        if (++argi < argc) {
+                            args.readChannels = atoi(argv[argi]);
+                        } else {
+                            usage(argv);
+                            throw std::runtime_error("missing read channels argument");
+                        }
+                    } else if (std::string(argv[argi]) == "--channels") {
+                        if (++argi < argc) {
+                            args.channels = parse_range(argv[argi]);
+                        } else {
+                            usage(argv);
+                            throw std::runtime_error("missing channels argument");
+                        }
+                    } else if (std::string(argv[argi]) == "--pols") {
+                        if (++argi < argc) {
+                            args.pols = parse_range(argv[argi]);
+                        } else {
+                            usage(argv);
+                            throw std::runtime_error("missing pols argument");
+                        }
+                    } else if (std::string(argv[argi]) == "--average") {
+                        char extra;
+                        if (++argi >= argc) {
+                            usage(argv);
+                            throw std::runtime_error("missing average argument");
+                        }
+                        if (sscanf(argv[argi], "%d:%d%c", &args.averageTimes, &args.averageChannels, &extra) != 2) {
+                            throw std::runtime_error("bad average, expected times:channels: " + std::string(argv[argi]));
+                        }
+                    } else if (std::string(argv[argi]) == "--add-column") {
+                        args.addCorrected = true;
+                    } else if (std::string(argv[argi]) == "--overlap") {
+                        args.overlap = true;
+                    } else if (std::string(argv[argi]) == "--seed") {
+                        if (++argi < argc) {
+                            args.seed = strtoul(argv[argi], NULL, 10);
+                        } else {
+                            usage(argv);
+                            throw std::runtime_error("missing seed argument");
+                        }
+                    } else if (std::string(argv[argi]) == "--input") {
+                        if (++argi < argc) {
+                            args.inputName = argv[argi];
+                        } else {
+                            usage(argv);
+                            throw std::runtime_error("missing input argument");
+                        }
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("unknown option: " + std::string(argv[argi]));
+                    }
+                    break;
                 case 'h':
                     usage(argv);
                     return 0;
@@ -527,6 +3060,9 @@ int main(int argc, char const *argv[])
                 case 's':
                     args.stream = true;
                     break;
+                case 'g':
+                    args.generate = true;
+                    break;
                 case 'V':
                     args.validate = true;
                     break;
@@ -538,6 +3074,22 @@ int main(int argc, char const *argv[])
                         throw std::runtime_error("missing iterations argument");
                     }
                     break;
+                case 'W':
+                    if (++argi < argc) {
+                        args.nWarmup = atoi(argv[argi]);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing warmup argument");
+                    }
+                    break;
+                case 'r':
+                    if (++argi < argc) {
+                        args.nReps = std::max(1, atoi(argv[argi]));
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing repetitions argument");
+                    }
+                    break;
                 case 't':
                     if (++argi < argc) {
                         std::string tableTypeName(argv[argi]);
@@ -588,6 +3140,169 @@ int main(int argc, char const *argv[])
                         throw std::runtime_error("missing pols argument");
                     }
                     break;
+                case 'L':
+                    if (++argi < argc) {
+                        std::string lockModeName(argv[argi]);
+                        args.lockMode = lockModeFromName(lockModeName);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing lockmode argument");
+                    }
+                    break;
+                case 'l':
+                    args.lockPerTimestep = true;
+                    break;
+                case 'O':
+                    if (++argi < argc) {
+                        std::string storageModeName(argv[argi]);
+                        args.storageMode = storageModeFromName(storageModeName);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing storageoption argument");
+                    }
+                    break;
+                case 'b':
+                    if (++argi < argc) {
+                        args.blockSize = atoi(argv[argi]);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing blocksize argument");
+                    }
+                    break;
+                case 'm':
+                    if (++argi < argc) {
+                        std::string benchModeName(argv[argi]);
+                        args.benchMode = benchModeFromName(benchModeName);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing benchmode argument");
+                    }
+                    break;
+                case 'd':
+                    if (++argi < argc) {
+                        std::string stManTypeName(argv[argi]);
+                        args.stManType = stManTypeFromName(stManTypeName);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing stman argument");
+                    }
+                    break;
+                case 'R':
+                    if (++argi < argc) {
+                        args.tileRows = atoi(argv[argi]);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing tilerows argument");
+                    }
+                    break;
+                case 'M':
+                    if (++argi < argc) {
+                        std::string tsmModeName(argv[argi]);
+                        args.tsmMode = tsmModeFromName(tsmModeName);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing tsmoption argument");
+                    }
+                    break;
+                case 'Q':
+                    if (++argi < argc) {
+                        args.queryFile = argv[argi];
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing queryfile argument");
+                    }
+                    break;
+                case 'o':
+                    if (++argi < argc) {
+                        std::string rowOrderName(argv[argi]);
+                        args.rowOrder = rowOrderFromName(rowOrderName);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing roworder argument");
+                    }
+                    break;
+                case 'c':
+                    if (++argi < argc) {
+                        std::string columnName(argv[argi]);
+                        args.extraColumns.push_back(extraColumnFromName(columnName));
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing column argument");
+                    }
+                    break;
+                case 'x':
+                    if (++argi < argc) {
+                        std::string engineTypeName(argv[argi]);
+                        args.engineType = engineTypeFromName(engineTypeName);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing engine argument");
+                    }
+                    break;
+                case 'I':
+                    if (++argi < argc) {
+                        std::string ioLoadName(argv[argi]);
+                        args.ioLoad = ioLoadFromName(ioLoadName);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing I/O load argument");
+                    }
+                    break;
+                case 'K':
+                    if (++argi < argc) {
+                        std::string cpuLoadName(argv[argi]);
+                        args.cpuLoad = cpuLoadFromName(cpuLoadName);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing CPU load argument");
+                    }
+                    break;
+                case 'k':
+                    if (++argi < argc) {
+                        args.cpuThreads = atoi(argv[argi]);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing CPU threads argument");
+                    }
+                    break;
+                case 'F':
+                    if (++argi < argc) {
+                        args.flagDensity = atof(argv[argi]);
+                        if (args.flagDensity < 0 || args.flagDensity > 1) {
+                            throw std::runtime_error("flag density must be between 0 and 1");
+                        }
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing density argument");
+                    }
+                    break;
+                case 'p':
+                    if (++argi < argc) {
+                        std::string flagPatternName(argv[argi]);
+                        args.flagPattern = flagPatternFromName(flagPatternName);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing pattern argument");
+                    }
+                    break;
+                case 'e':
+                    if (++argi < argc) {
+                        std::string dataElementName(argv[argi]);
+                        args.dataElement = dataElementFromName(dataElementName);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing element argument");
+                    }
+                    break;
+                case 'E':
+                    if (++argi < argc) {
+                        std::string endianModeName(argv[argi]);
+                        args.endianMode = endianModeFromName(endianModeName);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing endian argument");
+                    }
+                    break;
                 default:
                     usage(argv);
                     std::ostringstream errStream;
@@ -597,100 +3312,281 @@ int main(int argc, char const *argv[])
         }
     }
 
+    if (args.lockPerTimestep && args.lockMode != LOCK_USER) {
+        throw std::runtime_error("-l only applies with -L user");
+    }
     if (args.stream && args.validate) {
         throw std::runtime_error("stream will fill table with junk, and does not validate");
     }
+    if (args.stream && args.benchMode == GROUP) {
+        throw std::runtime_error("stream writes the same TIME to every row, which leaves nothing to group");
+    }
+    if (!args.replayName.empty() && (args.validate || args.stream)) {
+        throw std::runtime_error("replay writes the data of an existing table, and does not validate or stream");
+    }
+    bool repeated = args.nWarmup > 0 || args.nReps != N_REPS || !args.resultsName.empty();
+    if (repeated && ((args.benchMode != WRITE && args.benchMode != READ) || !args.replayName.empty())) {
+        throw std::runtime_error("-W, -r and --results only apply to the WRITE and READ modes");
+    }
 
-    if (args.verbosity >= 0) {
+    // replay prints the shape of the table it replays instead
+    if (args.verbosity >= 0 && args.replayName.empty()) {
         cout << "# nTimes=" << args.nTimes << ", nBls=" << args.nBls << ", nChs=" << args.nChs << ", nPols=" << args.nPols \
             << ", tableType=" << tableTypeNames[args.tableType] << ", writeMode=" << writeModeNames[args.writeMode] \
             << ", iterations=" << args.nIters;
+        if (args.benchMode != DEFAULT_BENCHMODE) {
+            cout << ", benchMode=" << benchModeNames[args.benchMode];
+        }
         if (args.stream) {
             cout << ", streaming";
         }
+        if (args.lockMode != DEFAULT_LOCKMODE) {
+            cout << ", lockMode=" << lockModeNames[args.lockMode];
+            if (args.lockMode == LOCK_USER) {
+                cout << (args.lockPerTimestep ? " per timestep" : " per iteration");
+            }
+        }
+        if (args.storageMode != DEFAULT_STORAGEMODE) {
+            cout << ", storage=" << storageModeNames[args.storageMode];
+            if (args.blockSize > 0) {
+                cout << ", blockSize=" << args.blockSize;
+            }
+        }
+        if (args.stManType != DEFAULT_STMANTYPE) {
+            cout << ", stMan=" << stManTypeNames[args.stManType];
+            if (args.tileRows > 0) {
+                cout << ", tileRows=" << args.tileRows;
+            }
+        }
+        if (args.tsmMode != DEFAULT_TSMMODE) {
+            cout << ", tsm=" << tsmModeNames[args.tsmMode];
+        }
+        if (args.endianMode != DEFAULT_ENDIANMODE) {
+            cout << ", endian=" << endianModeNames[args.endianMode];
+        }
+        if (args.rowOrder != DEFAULT_ROWORDER) {
+            cout << ", rowOrder=" << rowOrderNames[args.rowOrder];
+        }
+        for (ExtraColumn column : args.extraColumns) {
+            cout << ", +" << extraColumnNames[column];
+        }
+        if (args.dataElement != DEFAULT_DATAELEMENT) {
+            cout << ", dataElement=" << dataElementNames[args.dataElement];
+        }
+        if (args.engineType != DEFAULT_ENGINETYPE) {
+            cout << ", engine=" << engineTypeNames[args.engineType];
+        }
+        if (has_flags(args)) {
+            cout << ", flagDensity=" << args.flagDensity << ", flagPattern=" << flagPatternNames[args.flagPattern];
+        }
+        if (args.benchMode == APPLYCAL && args.addCorrected) {
+            cout << ", addColumn";
+        }
+        if (args.benchMode == INGEST) {
+            cout << ", cadence=" << args.cadence << "s";
+        }
+        if (args.benchMode == SLICE) {
+            cout << ", channels=" << args.channels.start << ":" << args.channels.width << ":" << args.channels.stride \
+                << ", pols=" << args.pols.start << ":" << args.pols.width << ":" << args.pols.stride;
+        }
+        if (args.benchMode == REDUCE) {
+            cout << ", average=" << args.averageTimes << ":" << args.averageChannels;
+            if (args.overlap) cout << ", overlap";
+        }
+        if (args.benchMode == RANDOM) {
+            cout << ", reads=" << args.nReads << ", readChannels=" << args.readChannels << ", seed=" << args.seed;
+        }
+        if (args.ioLoad != IOLOAD_NONE) {
+            cout << ", ioLoad=" << ioLoadNames[args.ioLoad] << " at " << args.ioRate << " MiB/s";
+        }
+        if (args.cpuLoad != CPULOAD_NONE) {
+            cout << ", cpuLoad=" << cpuLoadNames[args.cpuLoad] << " on " << args.cpuThreads << " threads";
+        }
+        if (on_demand(args)) {
+            cout << ", generate=on demand";
+        }
+        if (args.nWarmup > 0) {
+            cout << ", warmup=" << args.nWarmup;
+        }
+        if (args.nReps != N_REPS) {
+            cout << ", repetitions=" << args.nReps;
+        }
         cout << endl;
         flush(cout);
     }
 
-    Vector<Double> times(args.nTimes * args.nBls);
-    Array<Float> uvws(IPosition(2, 3, args.nTimes * args.nBls));
-    Array<Complex> data(IPosition(3, args.nPols, args.nChs, args.nTimes * args.nBls));
+    String tableName("/tmp/table.data/");
+    if (!args.replayName.empty()) {
+        bench_replay(tableName, args);
+        return 0;
+    }
+    if (args.benchMode == COPY && !args.inputName.empty()) {
+        Table input(args.inputName);
+        bench_copy(input, args);
+        return 0;
+    }
 
-    synthesize_data(times, uvws, data, args);
+    Workloads columns = make_workloads(args);
+    synthesize_data(columns, args);
 
-    Table tab = setup_table("/tmp/table.data/", args);
+    Table tab = setup_table(tableName, columns, args);
 
     if (args.validate) {
-        switch (args.tableType) {
-            case TIME:
-                fill_time_col(tab, times, args);
-                compare_time_col(tab, times, args);
-                break;
-            case UVW:
-                fill_uvw_col(tab, uvws, args);
-                compare_uvw_col(tab, uvws, args);
-                break;
-            case DATA:
-                fill_data_col(tab, data, args);
-                compare_data_col(tab, data, args);
-                break;
-            case COLUMNWISE:
-                fill_time_col(tab, times, args);
-                fill_uvw_col(tab, uvws, args);
-                fill_data_col(tab, data, args);
-                compare_time_col(tab, times, args);
-                compare_uvw_col(tab, uvws, args);
-                compare_data_col(tab, data, args);
-                break;
-            case ROWWISE:
-                fill_rowwise(tab, times, uvws, data, args);
-                compare_time_col(tab, times, args);
-                compare_uvw_col(tab, uvws, args);
-                compare_data_col(tab, data, args);
-                break;
+        // validation is not timed, so hold one lock around the fill and compare
+        args.lockPerTimestep = false;
+        user_lock(tab, args, false, FileLocker::Write);
+        write_table(tab, columns, args);
+        for (auto& column : columns) {
+            if (args.engineType != ENGINE_NONE && column->name == engine_column(args)) {
+                column->tolerance = engine_tolerance(args);
+            }
+            column->compare(tab, args);
+        }
+        user_unlock(tab, args, false);
+        if (args.benchMode == REDUCE) {
+            Table outTab = create_reduced_table(tab, args);
+            ReduceStages stages;
+            reduce_table(tab, outTab, stages, args);
+            check_reduced(tab, outTab, args);
+        }
+        if (args.benchMode == APPLYCAL) {
+            // identity matrices must leave DATA as it is, the synthetic gains
+            // must match a plain matrix product
+            check_applycal(tab, args);
+            if (args.addCorrected) {
+                add_column(tab, "CORRECTED_DATA", IPosition(2, args.nPols, args.nChs), args);
+            }
+            ApplycalStages stages;
+            for (bool synthetic : {false, true}) {
+                std::vector<Complex> jones = make_jones(synthetic, args);
+                applycal_table(tab, jones, stages, args);
+                check_corrected(tab, jones, args);
+            }
         }
         printf("PASS\n");
         return 0;
     }
 
-    // gets start time on construction
-    Timer timer;
-    int i = 0;
-    while (i++ < args.nIters) {
+    if (args.benchMode != WRITE && args.benchMode != INGEST) {
+        // populate the table once, then close it so that it is reopened with
+        // the tiled storage manager option rather than found in the table cache.
+        user_lock(tab, args, false, FileLocker::Write);
+        write_table(tab, columns, args);
+        user_unlock(tab, args, false);
+        close_table(tab, columns);
+        tab = open_table(tableName, args, args.benchMode == QUERY || args.benchMode == APPLYCAL ? Table::Update : Table::Old);
+    }
+
+    // runs until main returns, next to the table so it shares its filesystem
+    Interference interference("/tmp/table.interference", args);
+
+    if (args.benchMode == INGEST) {
+        bench_ingest(tab, columns, args);
+        return 0;
+    }
+
+    if (args.benchMode == GROUP) {
+        bench_groups(tab, columns, args);
+        return 0;
+    }
+    if (args.benchMode == QUERY) {
+        bench_queries(tab, args);
+        return 0;
+    }
+    if (args.benchMode == BASELINE) {
+        bench_baselines(tab, columns, args);
+        return 0;
+    }
+    if (args.benchMode == COPY) {
+        bench_copy(tab, args);
+        return 0;
+    }
+    if (args.benchMode == RANDOM) {
+        bench_random(tab, columns, args);
+        return 0;
+    }
+    if (args.benchMode == SLICE) {
+        bench_slice(tab, columns, args);
+        return 0;
+    }
+    if (args.benchMode == REDUCE) {
+        bench_reduce(tab, args);
+        return 0;
+    }
+    if (args.benchMode == APPLYCAL) {
+        bench_applycal(tab, args);
+        return 0;
+    }
+
+    // warm the page cache and the table's buffers without timing
+    for (int i = 0; i < args.nWarmup; i++) {
         if (args.verbosity >= 0) {
-            cerr << "iteration " << i << " of " << args.nIters << "\r";
+            cerr << "warmup " << i + 1 << " of " << args.nWarmup << "\r";
         }
-        switch (args.tableType) {
-            case TIME:
-                if (args.stream) stream_time_col(tab, times, args); else fill_time_col(tab, times, args);
-                break;
-            case UVW:
-                if (args.stream) stream_uvw_col(tab, uvws, args); else fill_uvw_col(tab, uvws, args);
-                break;
-            case DATA:
-                if (args.stream) stream_data_col(tab, data, args); else fill_data_col(tab, data, args);
-                break;
-            case COLUMNWISE:
-                if (args.stream) {
-                    stream_time_col(tab, times, args);
-                    stream_uvw_col(tab, uvws, args);
-                    stream_data_col(tab, data, args);
-                } else {
-                    fill_time_col(tab, times, args);
-                    fill_uvw_col(tab, uvws, args);
-                    fill_data_col(tab, data, args);
-                }
-                break;
-            case ROWWISE:
-                if (args.stream) stream_rowwise(tab, times, uvws, data, args); else fill_rowwise(tab, times, uvws, data, args);
-                break;
+        user_lock(tab, args, false, args.benchMode == READ ? FileLocker::Read : FileLocker::Write);
+        if (args.benchMode == READ) {
+            read_table(tab, columns, args);
+        } else {
+            write_table(tab, columns, args);
         }
+        user_unlock(tab, args, false);
     }
-    if (args.nIters > 0) {
-        cerr << "                          \r";
-        std::cout << "user:   " << timer.user () << "s" << endl;
-        std::cout << "system: " << timer.system () << "s" << endl;
-        std::cout << "real:   " << timer.real () << "s" << endl;
+
+    double nBytes = (double)args.nIters * args.nTimes * args.nBls * row_bytes(columns);
+    for (auto& column : columns) {
+        column->synthTime = 0;
+    }
+    std::vector<Repetition> repetitions;
+    struct rusage usageFirst;
+    getrusage(RUSAGE_SELF, &usageFirst);
+    for (int rep = 0; rep < args.nReps; rep++) {
+        struct rusage usageBefore;
+        getrusage(RUSAGE_SELF, &usageBefore);
+        // gets start time on construction
+        Timer timer;
+        int i = 0;
+        while (i++ < args.nIters) {
+            if (args.verbosity >= 0) {
+                cerr << "repetition " << rep + 1 << " of " << args.nReps << ", iteration " << i << " of " << args.nIters << "\r";
+            }
+            user_lock(tab, args, false, args.benchMode == READ ? FileLocker::Read : FileLocker::Write);
+            if (args.benchMode == READ) {
+                read_table(tab, columns, args);
+            } else {
+                write_table(tab, columns, args);
+            }
+            user_unlock(tab, args, false);
+        }
+        if (args.nIters > 0) {
+            cerr << "                                                  \r";
+            if (args.nReps == 1) {
+                report(timer, usageBefore, nBytes);
+            }
+            repetitions.push_back(Repetition{nBytes / timer.real() / (1024 * 1024), timer.real(), timer.user(), timer.system()});
+        }
+    }
+    if (args.nIters > 0 && args.nReps > 1) {
+        report_repetitions(repetitions, usageFirst, args);
+    }
+    if (args.nIters > 0 && has_flags(args)) {
+        report_flag_conversion(args, repetitions.back().user);
+    }
+    if (args.nIters > 0 && on_demand(args)) {
+        report_synthesis(columns, repetitions);
+    }
+    if (args.engineType != ENGINE_NONE && !args.stream) {
+        report_engine(tab, columns, args);
+    }
+    if (!args.resultsName.empty()) {
+        write_results(args.resultsName, repetitions);
+    }
+
+    if (args.verbosity >= 0) {
+        tab.flush();
+        long nFiles = 0;
+        long long nBytes = 0;
+        disk_usage(tab.tableName(), nFiles, nBytes);
+        std::cout << "files:  " << nFiles << ", " << nBytes << " bytes" << endl;
     }
 
     return 0;
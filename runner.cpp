@@ -0,0 +1,407 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+
+#include "stats.h"
+
+// the lines of main's output that are collected into the report
+const char* resultKeys[] = {"user", "system", "real", "rate", "faults", "maxrss", "files"};
+#define NUM_RESULTKEYS (sizeof(resultKeys) / sizeof(resultKeys[0]))
+
+// an option of main and the values it takes in a matrix, "off" leaves the
+// option out and "on" passes it without a value
+struct Axis {
+    std::string option;
+    std::vector<std::string> values;
+};
+
+// a scenario is excluded when it matches every option=value of a rule
+typedef std::vector<std::pair<std::string, std::string>> Rule;
+
+// a Cartesian product of axes, minus the excluded scenarios
+struct Matrix {
+    std::string name;
+    std::string args;
+    std::vector<Axis> axes;
+    std::vector<Rule> excludes;
+};
+
+// one expanded scenario, with the value of each option and its results
+struct Scenario {
+    std::string matrix;
+    std::map<std::string, std::string> values;
+    std::string command;
+    std::map<std::string, std::string> results;
+    int status = 0;
+};
+
+struct Args {
+    std::string configName;
+    std::string exe = "./main";
+    std::string extraArgs;
+    std::string reportName;
+    bool dryRun = false;
+    std::string baselineName;
+    std::string candidateName;
+    double threshold = 5;
+};
+
+void usage(char const *argv[]) {
+    std::cout << "Usage: " << argv[0] << " [-h] [-n] [-x <exe>] [-a <args>] [-o <report>] <config>\n" \
+        << "       " << argv[0] << " -c <baseline> <candidate> [-p <percent>]\n" \
+        << "  -h: print this help message\n" \
+        << "  -n: print the scenarios without running them\n" \
+        << "  -x <exe>: benchmark to run (default: ./main)\n" \
+        << "  -a <args>: extra arguments for every scenario\n" \
+        << "  -o <report>: also write the markdown report to this file\n" \
+        << "  -c <baseline> <candidate>: compare the rates in two ./main --results files\n" \
+        << "  -p <percent>: with -c, fail on a significant slowdown larger than this (default: 5)\n";
+}
+
+// split a line on whitespace, keeping double quoted text together
+std::vector<std::string> tokenize(const std::string& line) {
+    std::vector<std::string> tokens;
+    std::string token;
+    bool quoted = false, inToken = false;
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+            inToken = true;
+        } else if (!quoted && isspace(c)) {
+            if (inToken) tokens.push_back(token);
+            token.clear();
+            inToken = false;
+        } else {
+            token += c;
+            inToken = true;
+        }
+    }
+    if (quoted) {
+        throw std::runtime_error("unterminated quote: " + line);
+    }
+    if (inToken) tokens.push_back(token);
+    return tokens;
+}
+
+// Parse a config file. Lines before the first [section] are shared by every
+// section, and each section is a matrix of its own:
+//   # comment
+//   args = -i 10
+//   -t = columnwise rowwise
+//   exclude -t=rowwise -w=column
+//   [name]
+std::vector<Matrix> load_config(const std::string& configName) {
+    std::ifstream config(configName);
+    if (!config) {
+        throw std::runtime_error("could not open config: " + configName);
+    }
+    Matrix shared;
+    std::vector<Matrix> matrices;
+    Matrix* current = &shared;
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(config, line)) {
+        lineNo++;
+        std::vector<std::string> tokens = tokenize(line.substr(0, line.find('#')));
+        if (tokens.empty()) continue;
+        std::ostringstream where;
+        where << configName << ":" << lineNo << ": ";
+        if (tokens[0].front() == '[' && tokens[0].back() == ']') {
+            matrices.push_back(shared);
+            matrices.back().name = tokens[0].substr(1, tokens[0].size() - 2);
+            current = &matrices.back();
+        } else if (tokens[0] == "exclude") {
+            Rule rule;
+            for (size_t i = 1; i < tokens.size(); i++) {
+                size_t eq = tokens[i].find('=');
+                if (eq == std::string::npos) {
+                    throw std::runtime_error(where.str() + "expected option=value: " + tokens[i]);
+                }
+                rule.push_back(std::make_pair(tokens[i].substr(0, eq), tokens[i].substr(eq + 1)));
+            }
+            current->excludes.push_back(rule);
+        } else if (tokens.size() >= 2 && tokens[1] == "=") {
+            if (tokens[0] == "args") {
+                for (size_t i = 2; i < tokens.size(); i++) {
+                    current->args += " " + tokens[i];
+                }
+            } else {
+                Axis axis;
+                axis.option = tokens[0];
+                axis.values.assign(tokens.begin() + 2, tokens.end());
+                if (axis.values.empty()) {
+                    throw std::runtime_error(where.str() + "axis without values: " + axis.option);
+                }
+                current->axes.push_back(axis);
+            }
+        } else {
+            throw std::runtime_error(where.str() + "could not parse: " + line);
+        }
+    }
+    if (matrices.empty()) {
+        matrices.push_back(shared);
+    }
+    return matrices;
+}
+
+// the rates (first column) of a ./main --results file
+std::vector<double> load_rates(const std::string& resultsName) {
+    std::ifstream results(resultsName);
+    if (!results) {
+        throw std::runtime_error("could not open results: " + resultsName);
+    }
+    std::vector<double> rates;
+    std::string line;
+    while (std::getline(results, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        rates.push_back(std::stod(line));
+    }
+    if (rates.size() < 2) {
+        throw std::runtime_error("need at least 2 repetitions to compare: " + resultsName);
+    }
+    return rates;
+}
+
+// Compare the throughput of a candidate against a baseline with Welch's
+// t-test at 95% confidence. Returns non-zero for a significant slowdown of
+// more than the threshold.
+int compare(const Args& args) {
+    Summary baseline = summarize(load_rates(args.baselineName), true);
+    Summary candidate = summarize(load_rates(args.candidateName), true);
+    double df;
+    double t = welch_t(baseline, candidate, df);
+    if (std::isnan(t)) {
+        printf("insufficient samples: %zu baseline and %zu candidate repetitions left after outlier rejection, need 2 each\n",
+            baseline.n, candidate.n);
+        return 1;
+    }
+    double change = 100 * (candidate.mean - baseline.mean) / baseline.mean;
+    bool significant = std::fabs(t) > t_critical95(df);
+    printf("%-10s %6s %12s %12s %12s %12s\n", "", "n", "mean", "median", "stddev", "95% CI");
+    printf("%-10s %6zu %12.2f %12.2f %12.2f %12.2f\n", "baseline", baseline.n, baseline.mean, baseline.median,
+        baseline.stddev, baseline.ci95);
+    printf("%-10s %6zu %12.2f %12.2f %12.2f %12.2f\n", "candidate", candidate.n, candidate.mean, candidate.median,
+        candidate.stddev, candidate.ci95);
+    printf("change: %+.2f%% (t=%.2f, df=%.1f, %s)\n", change, t, df, significant ? "significant" : "not significant");
+    if (significant && change < -args.threshold) {
+        printf("regression: throughput dropped by more than %.1f%%\n", args.threshold);
+        return 1;
+    }
+    return 0;
+}
+
+bool excluded(const Matrix& matrix, std::map<std::string, std::string>& values) {
+    for (const Rule& rule : matrix.excludes) {
+        bool match = true;
+        for (auto& term : rule) {
+            if (values[term.first] != term.second) match = false;
+        }
+        if (match) return true;
+    }
+    return false;
+}
+
+// expand the Cartesian product of a matrix's axes, like an odometer with the
+// last axis turning fastest
+void expand(const Matrix& matrix, const Args& args, std::vector<Scenario>& scenarios) {
+    std::vector<size_t> index(matrix.axes.size(), 0);
+    while (true) {
+        Scenario scenario;
+        scenario.matrix = matrix.name;
+        scenario.command = args.exe + matrix.args + args.extraArgs;
+        for (size_t i = 0; i < matrix.axes.size(); i++) {
+            const Axis& axis = matrix.axes[i];
+            const std::string& value = axis.values[index[i]];
+            scenario.values[axis.option] = value;
+            if (value == "on") {
+                scenario.command += " " + axis.option;
+            } else if (value != "off") {
+                scenario.command += " " + axis.option + " " + value;
+            }
+        }
+        if (!excluded(matrix, scenario.values)) {
+            scenarios.push_back(scenario);
+        }
+        size_t i = matrix.axes.size();
+        while (i > 0 && ++index[i - 1] == matrix.axes[i - 1].values.size()) {
+            index[--i] = 0;
+        }
+        if (i == 0) break;
+    }
+}
+
+// run a scenario in a fresh process, echoing its output and collecting the
+// "key: value" lines of the results
+void run(Scenario& scenario) {
+    std::cout << scenario.command << std::endl;
+    FILE* pipe = popen((scenario.command + " 2>&1").c_str(), "r");
+    if (!pipe) {
+        throw std::runtime_error("could not run: " + scenario.command);
+    }
+    char buffer[4096];
+    while (fgets(buffer, sizeof(buffer), pipe)) {
+        std::string line(buffer);
+        std::cout << line << std::flush;
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string key = line.substr(0, colon);
+        for (size_t i = 0; i < NUM_RESULTKEYS; i++) {
+            if (key != resultKeys[i]) continue;
+            size_t start = line.find_first_not_of(' ', colon + 1);
+            size_t end = line.find_last_not_of(" \n");
+            scenario.results[key] = start <= end ? line.substr(start, end - start + 1) : "";
+        }
+    }
+    int status = pclose(pipe);
+    scenario.status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// one markdown table with a column per option and per result
+void write_report(std::ostream& out, const std::vector<Matrix>& matrices, const std::vector<Scenario>& scenarios) {
+    std::vector<std::string> options;
+    bool named = false;
+    for (const Matrix& matrix : matrices) {
+        named = named || !matrix.name.empty();
+        for (const Axis& axis : matrix.axes) {
+            if (std::find(options.begin(), options.end(), axis.option) == options.end()) {
+                options.push_back(axis.option);
+            }
+        }
+    }
+    std::vector<std::string> header;
+    if (named) header.push_back("scenario");
+    header.insert(header.end(), options.begin(), options.end());
+    header.insert(header.end(), resultKeys, resultKeys + NUM_RESULTKEYS);
+    header.push_back("status");
+    out << "|";
+    for (auto& column : header) out << " " << column << " |";
+    out << std::endl << "|";
+    for (auto& column : header) out << std::string(column.size() + 2, '-') << "|";
+    out << std::endl;
+    for (const Scenario& scenario : scenarios) {
+        out << "|";
+        if (named) out << " " << scenario.matrix << " |";
+        for (auto& option : options) {
+            auto value = scenario.values.find(option);
+            out << " " << (value == scenario.values.end() ? "" : value->second) << " |";
+        }
+        for (size_t i = 0; i < NUM_RESULTKEYS; i++) {
+            auto result = scenario.results.find(resultKeys[i]);
+            out << " " << (result == scenario.results.end() ? "" : result->second) << " |";
+        }
+        out << " " << (scenario.status == 0 ? "ok" : "failed") << " |" << std::endl;
+    }
+}
+
+int main(int argc, char const *argv[])
+{
+    Args args;
+
+    int argi = 0;
+    while (++argi < argc) {
+        if (argv[argi][0] == '-') {
+            switch (argv[argi][1]) {
+                case 'h':
+                    usage(argv);
+                    return 0;
+                case 'n':
+                    args.dryRun = true;
+                    break;
+                case 'x':
+                    if (++argi < argc) {
+                        args.exe = argv[argi];
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing exe argument");
+                    }
+                    break;
+                case 'a':
+                    if (++argi < argc) {
+                        args.extraArgs += std::string(" ") + argv[argi];
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing args argument");
+                    }
+                    break;
+                case 'c':
+                    if (argi + 2 < argc) {
+                        args.baselineName = argv[++argi];
+                        args.candidateName = argv[++argi];
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing compare arguments");
+                    }
+                    break;
+                case 'p':
+                    if (++argi < argc) {
+                        args.threshold = atof(argv[argi]);
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing percent argument");
+                    }
+                    break;
+                case 'o':
+                    if (++argi < argc) {
+                        args.reportName = argv[argi];
+                    } else {
+                        usage(argv);
+                        throw std::runtime_error("missing report argument");
+                    }
+                    break;
+                default:
+                    usage(argv);
+                    throw std::runtime_error("unknown option: " + std::string(argv[argi]));
+            }
+        } else {
+            args.configName = argv[argi];
+        }
+    }
+    if (!args.baselineName.empty()) {
+        return compare(args);
+    }
+    if (args.configName.empty()) {
+        usage(argv);
+        throw std::runtime_error("missing config");
+    }
+
+    std::vector<Matrix> matrices = load_config(args.configName);
+    std::vector<Scenario> scenarios;
+    for (const Matrix& matrix : matrices) {
+        expand(matrix, args, scenarios);
+    }
+
+    if (args.dryRun) {
+        for (const Scenario& scenario : scenarios) {
+            std::cout << scenario.command << std::endl;
+        }
+        return 0;
+    }
+
+    int nFailed = 0;
+    for (Scenario& scenario : scenarios) {
+        run(scenario);
+        if (scenario.status != 0) nFailed++;
+    }
+
+    std::cout << std::endl;
+    write_report(std::cout, matrices, scenarios);
+    if (!args.reportName.empty()) {
+        std::ofstream report(args.reportName);
+        write_report(report, matrices, scenarios);
+    }
+    if (nFailed > 0) {
+        std::cerr << nFailed << " of " << scenarios.size() << " scenarios failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+#ifndef STATS_H
+#define STATS_H
+
+// summary statistics of repeated measurements, shared by main and runner
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// two-sided 95% critical values of Student's t distribution for 1 to 30
+// degrees of freedom, beyond which a series expansion around 1.96 is close
+inline double t_critical95(double df) {
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df < 1) return INFINITY;
+    if (df <= 30) return table[(int)df - 1];
+    return 1.96 + 2.37 / df;
+}
+
+struct Summary {
+    size_t n = 0;
+    size_t nOutliers = 0;
+    double mean = 0;
+    double median = 0;
+    double stddev = 0;
+    // half width of the 95% confidence interval of the mean
+    double ci95 = 0;
+};
+
+// Summarize a set of measurements, leaving out values beyond Tukey's fences
+// (1.5 interquartile ranges outside the quartiles) when rejecting outliers.
+inline Summary summarize(std::vector<double> values, bool rejectOutliers) {
+    Summary summary;
+    if (values.empty()) return summary;
+    std::sort(values.begin(), values.end());
+    if (rejectOutliers && values.size() >= 4) {
+        double q1 = values[values.size() / 4];
+        double q3 = values[values.size() * 3 / 4];
+        double low = q1 - 1.5 * (q3 - q1), high = q3 + 1.5 * (q3 - q1);
+        std::vector<double> kept;
+        for (double value : values) {
+            if (value >= low && value <= high) kept.push_back(value);
+        }
+        summary.nOutliers = values.size() - kept.size();
+        values.swap(kept);
+    }
+    summary.n = values.size();
+    double total = 0;
+    for (double value : values) total += value;
+    summary.mean = total / summary.n;
+    summary.median = summary.n % 2 ? values[summary.n / 2] : (values[summary.n / 2 - 1] + values[summary.n / 2]) / 2;
+    if (summary.n > 1) {
+        double squares = 0;
+        for (double value : values) squares += (value - summary.mean) * (value - summary.mean);
+        summary.stddev = std::sqrt(squares / (summary.n - 1));
+        summary.ci95 = t_critical95(summary.n - 1) * summary.stddev / std::sqrt(summary.n);
+    }
+    return summary;
+}
+
+// Welch's t-test of the difference between the means of b and a, which
+// doesn't assume equal variances. Returns the t statistic and sets the
+// Welch–Satterthwaite degrees of freedom, or NAN for both when either side
+// has fewer than 2 samples (e.g. after outlier rejection).
+inline double welch_t(const Summary& a, const Summary& b, double& df) {
+    if (a.n < 2 || b.n < 2) {
+        df = NAN;
+        return NAN;
+    }
+    double va = a.stddev * a.stddev / a.n, vb = b.stddev * b.stddev / b.n;
+    if (va + vb == 0) {
+        df = INFINITY;
+        return b.mean == a.mean ? 0 : (b.mean > a.mean ? INFINITY : -INFINITY);
+    }
+    df = (va + vb) * (va + vb) / (va * va / (a.n - 1) + vb * vb / (b.n - 1));
+    return (b.mean - a.mean) / std::sqrt(va + vb);
+}
+
+#endif
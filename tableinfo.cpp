@@ -1,9 +1,636 @@
 #include <casacore/tables/Tables.h>
+#include <casacore/casa/Utilities/ValType.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace casacore;
 
+// the advisor aims for tiles of about this many bytes
+#define TILE_BYTES (1024 * 1024)
+// and warns when a recommended cache is larger than this
+#define CACHE_BUDGET (1024LL * 1024 * 1024)
+
+// sizes of the files in a table directory, by name
+std::map<std::string, long long> file_sizes(const std::string& path) {
+    std::map<std::string, long long> sizes;
+    DIR* dir = opendir(path.c_str());
+    if (dir == NULL) {
+        throw std::runtime_error("could not open directory " + path);
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        std::string name(entry->d_name);
+        struct stat st;
+        if (stat((path + "/" + name).c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            sizes[name] = st.st_size;
+        }
+    }
+    closedir(dir);
+    return sizes;
+}
+
+// whether a file belongs to the data manager with the sequence number, its
+// files are table.f<seqnr> followed by an optional non-digit suffix
+bool is_dm_file(const std::string& name, int seqnr) {
+    std::string prefix = "table.f" + std::to_string(seqnr);
+    return name.compare(0, prefix.size(), prefix) == 0
+        && (name.size() == prefix.size() || !isdigit(name[prefix.size()]));
+}
+
+// the bytes an element of a data type takes on disk, Bool is stored as bits
+double element_bytes(DataType dataType) {
+    return dataType == TpBool ? 1.0 / 8 : ValType::getTypeSize(dataType);
+}
+
+// format a scalar or integer array field of a data manager spec
+std::string field_string(const Record& rec, const String& name) {
+    std::ostringstream out;
+    switch (rec.dataType(name)) {
+        case TpBool: out << rec.asBool(name); break;
+        case TpInt: out << rec.asInt(name); break;
+        case TpUInt: out << rec.asuInt(name); break;
+        case TpInt64: out << rec.asInt64(name); break;
+        case TpString: out << rec.asString(name); break;
+        case TpArrayInt: out << rec.asArrayInt(name); break;
+        default: out << "?"; break;
+    }
+    return out.str();
+}
+
+// the interesting parts of a data manager spec: bucket and cache sizes, and
+// the tile shape of the first hypercube
+std::string spec_string(const Record& spec) {
+    std::ostringstream out;
+    const char* keys[] = {"BUCKETSIZE", "PERSCACHESIZE", "DEFAULTTILESHAPE", "MAXIMUMCACHESIZE"};
+    for (const char* key : keys) {
+        if (spec.isDefined(key)) {
+            out << key << "=" << field_string(spec, key) << " ";
+        }
+    }
+    if (spec.isDefined("HYPERCUBES")) {
+        const Record& hypercubes = spec.subRecord("HYPERCUBES");
+        out << "hypercubes=" << hypercubes.nfields() << " ";
+        if (hypercubes.nfields() > 0) {
+            const Record& first = hypercubes.subRecord(0);
+            const char* cubeKeys[] = {"CubeShape", "TileShape", "BucketSize"};
+            for (const char* key : cubeKeys) {
+                if (first.isDefined(key)) {
+                    out << key << "=" << field_string(first, key) << " ";
+                }
+            }
+        }
+    }
+    return out.str();
+}
+
+// whether the data managers' files are packed in a MultiFile or MultiHDF5
+// container (table.mf or table.mfh5) rather than being table.f<seqnr> files
+bool is_multifile(const std::map<std::string, long long>& sizes) {
+    for (auto& file : sizes) {
+        if (file.first.compare(0, 8, "table.mf") == 0) return true;
+    }
+    return false;
+}
+
+// print the data managers of the table with the columns they hold, their
+// spec, the size of their files on disk and an estimate of the bytes per row
+// of each column, splitting a data manager's bytes by the columns' cell sizes
+// (Bool cells are stored as bits). Virtual engines have no files, their data
+// is in the stored columns, and in a MultiFile or MultiHDF5 container the
+// bytes of a data manager are unknown.
+void print_data_managers(const Table& table) {
+    std::map<std::string, long long> sizes = file_sizes(table.tableName());
+    bool multifile = is_multifile(sizes);
+    Record dminfo = table.dataManagerInfo();
+    rownr_t nrow = std::max(table.nrow(), (rownr_t)1);
+    std::cout << std::endl << "Data managers:" << std::endl;
+    printf("%-5s %-20s %-20s %16s %s\n", "SEQNR", "TYPE", "NAME", "BYTES", "SPEC");
+    struct ColumnBytes {
+        std::string column;
+        std::string dataManager;
+        double rowBytes;
+        // why rowBytes is unknown, or empty
+        std::string note;
+    };
+    std::vector<ColumnBytes> rowBytes;
+    for (uInt i = 0; i < dminfo.nfields(); i++) {
+        const Record& dm = dminfo.subRecord(i);
+        int seqnr = std::stoi(field_string(dm, "SEQNR"));
+        long long dmBytes = 0;
+        for (auto& file : sizes) {
+            if (is_dm_file(file.first, seqnr)) dmBytes += file.second;
+        }
+        std::string note;
+        if (!table.findDataManager(dm.asString("NAME"))->isStorageManager()) {
+            note = "n/a (virtual)";
+        } else if (multifile) {
+            note = "n/a (MultiFile)";
+        }
+        std::string bytes = note.empty() ? std::to_string(dmBytes) : note;
+        printf("%-5d %-20s %-20s %16s %s\n", seqnr, dm.asString("TYPE").c_str(), dm.asString("NAME").c_str(),
+            bytes.c_str(), dm.isDefined("SPEC") ? spec_string(dm.subRecord("SPEC")).c_str() : "");
+
+        // nominal cell bytes of each column, from the shape of the first row
+        Vector<String> columns(dm.asArrayString("COLUMNS"));
+        std::vector<double> cellBytes;
+        double totalCellBytes = 0;
+        for (const String& column : columns) {
+            const ColumnDesc& colDesc = table.tableDesc().columnDesc(column);
+            double nBytes = element_bytes(colDesc.dataType());
+            if (colDesc.isArray()) {
+                TableColumn col(table, column);
+                nBytes *= table.nrow() > 0 && col.isDefined(0) ? col.shape(0).product() : 0;
+            }
+            cellBytes.push_back(nBytes);
+            totalCellBytes += nBytes;
+        }
+        for (size_t j = 0; j < columns.size(); j++) {
+            double share = totalCellBytes > 0 ? cellBytes[j] / totalCellBytes : 1.0 / columns.size();
+            rowBytes.push_back(ColumnBytes{columns[j], dm.asString("NAME"), share * dmBytes / nrow, note});
+        }
+    }
+
+    std::cout << std::endl << "Files:" << std::endl;
+    for (auto& file : sizes) {
+        printf("%-20s %12lld\n", file.first.c_str(), file.second);
+    }
+
+    std::cout << std::endl << "Columns by data manager, with estimated bytes per row on disk:" << std::endl;
+    for (auto& column : rowBytes) {
+        if (column.note.empty()) {
+            printf("%-20s %-20s %12.1f\n", column.column.c_str(), column.dataManager.c_str(), column.rowBytes);
+        } else {
+            printf("%-20s %-20s %16s\n", column.column.c_str(), column.dataManager.c_str(), column.note.c_str());
+        }
+    }
+}
+
+// the sequence number of the data manager holding a column
+int column_seqnr(const Table& table, const String& column) {
+    Record dminfo = table.dataManagerInfo();
+    for (uInt i = 0; i < dminfo.nfields(); i++) {
+        const Record& dm = dminfo.subRecord(i);
+        Vector<String> columns(dm.asArrayString("COLUMNS"));
+        if (std::find(columns.begin(), columns.end(), column) != columns.end()) {
+            return std::stoi(field_string(dm, "SEQNR"));
+        }
+    }
+    return -1;
+}
+
+// drop a file from the page cache, writing back its dirty pages first since
+// DONTNEED leaves those in the cache. The file stays read only, which
+// fdatasync accepts, so that read only tables can be evicted too.
+void evict_file(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("could not open " + path);
+    }
+    if (fdatasync(fd) != 0) {
+        close(fd);
+        throw std::runtime_error("could not sync " + path + ": " + strerror(errno));
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// the files of a column's data manager, or the whole MultiFile container
+// that holds every data manager
+std::vector<std::string> column_files(const Table& table, const String& column) {
+    int seqnr = column_seqnr(table, column);
+    std::map<std::string, long long> sizes = file_sizes(table.tableName());
+    bool multifile = is_multifile(sizes);
+    std::vector<std::string> paths;
+    for (auto& file : sizes) {
+        if (multifile ? file.first.compare(0, 8, "table.mf") != 0 : !is_dm_file(file.first, seqnr)) continue;
+        paths.push_back(table.tableName() + "/" + file.first);
+    }
+    return paths;
+}
+
+// result of scanning one column
+struct Scan {
+    long long nBytes = 0;
+    double firstTime = 0;
+    double totalTime = 0;
+};
+
+// read a scalar column in chunks of rows into a reused buffer
+template <typename T>
+Scan scan_scalar(const Table& table, const String& column, rownr_t chunkRows) {
+    ScalarColumn<T> col(table, column);
+    Vector<T> buffer;
+    Scan scan;
+    auto start = std::chrono::steady_clock::now();
+    for (rownr_t row = 0; row < table.nrow(); row += chunkRows) {
+        rownr_t nRows = std::min(chunkRows, table.nrow() - row);
+        col.getColumnRange(Slicer(IPosition(1, row), IPosition(1, nRows)), buffer, True);
+        scan.nBytes += nRows * sizeof(T);
+        if (row == 0) {
+            scan.firstTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+    scan.totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return scan;
+}
+
+// read an array column in chunks of rows into a reused buffer, or cell by
+// cell when the shapes in a chunk differ or cells are undefined
+template <typename T>
+Scan scan_array(const Table& table, const String& column, rownr_t chunkRows) {
+    ArrayColumn<T> col(table, column);
+    Array<T> buffer;
+    Scan scan;
+    bool byCell = false;
+    auto start = std::chrono::steady_clock::now();
+    for (rownr_t row = 0; row < table.nrow(); row += chunkRows) {
+        rownr_t nRows = std::min(chunkRows, table.nrow() - row);
+        if (!byCell) {
+            try {
+                col.getColumnRange(Slicer(IPosition(1, row), IPosition(1, nRows)), buffer, True);
+                scan.nBytes += buffer.nelements() * sizeof(T);
+            } catch (std::exception& e) {
+                byCell = true;
+            }
+        }
+        if (byCell) {
+            for (rownr_t i = row; i < row + nRows; i++) {
+                if (!col.isDefined(i)) continue;
+                col.get(i, buffer, True);
+                scan.nBytes += buffer.nelements() * sizeof(T);
+            }
+        }
+        if (row == 0) {
+            scan.firstTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+    scan.totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return scan;
+}
+
+// read every column in full and print its read throughput and time to first
+// chunk. When cold, the table is closed before each column, so that the
+// storage managers' bucket and tile caches are dropped, and the column's files
+// are evicted from the page cache before it is reopened. The caller's table
+// must be the only one holding it open.
+void print_scan(Table& table, rownr_t chunkRows, bool cold) {
+    TableDesc desc = table.tableDesc();
+    String tableName = table.tableName();
+    std::cout << std::endl << "Scan in chunks of " << chunkRows << " rows" << (cold ? ", cold cache" : "") << ":" << std::endl;
+    if (cold && is_multifile(file_sizes(tableName))) {
+        std::cerr << "warning: the table is in a MultiFile container, so --cold evicts all of it before each column" << std::endl;
+    }
+    printf("%-20s %14s %12s %12s %12s\n", "Name", "bytes", "rows/s", "MiB/s", "first(ms)");
+    for (uInt i = 0; i < desc.ncolumn(); i++) {
+        const ColumnDesc& colDesc = desc.columnDesc(i);
+        String name = colDesc.name();
+        if (cold) {
+            std::vector<std::string> paths = column_files(table, name);
+            table = Table();
+            if (Table::isOpened(tableName)) {
+                throw std::runtime_error("can't scan cold, the table is still open elsewhere");
+            }
+            for (const std::string& path : paths) {
+                evict_file(path);
+            }
+            table = Table(tableName);
+        }
+        Scan scan;
+        bool scanned = true;
+        switch (colDesc.dataType()) {
+            case TpBool: scan = colDesc.isArray() ? scan_array<Bool>(table, name, chunkRows) : scan_scalar<Bool>(table, name, chunkRows); break;
+            case TpInt: scan = colDesc.isArray() ? scan_array<Int>(table, name, chunkRows) : scan_scalar<Int>(table, name, chunkRows); break;
+            case TpFloat: scan = colDesc.isArray() ? scan_array<Float>(table, name, chunkRows) : scan_scalar<Float>(table, name, chunkRows); break;
+            case TpDouble: scan = colDesc.isArray() ? scan_array<Double>(table, name, chunkRows) : scan_scalar<Double>(table, name, chunkRows); break;
+            case TpComplex: scan = colDesc.isArray() ? scan_array<Complex>(table, name, chunkRows) : scan_scalar<Complex>(table, name, chunkRows); break;
+            case TpDComplex: scan = colDesc.isArray() ? scan_array<DComplex>(table, name, chunkRows) : scan_scalar<DComplex>(table, name, chunkRows); break;
+            default: scanned = false; break;
+        }
+        if (!scanned) {
+            printf("%-20s %14s\n", name.c_str(), "unsupported type");
+            continue;
+        }
+        printf("%-20s %14lld %12.0f %12.1f %12.3f\n", name.c_str(), scan.nBytes, table.nrow() / scan.totalTime,
+            scan.nBytes / scan.totalTime / (1024 * 1024), 1e3 * scan.firstTime);
+    }
+}
+
+// the shape of an MS: timesteps, baselines, and whether rows are time-major
+struct Layout {
+    rownr_t nTimes = 1;
+    rownr_t nBls = 1;
+    bool timeMajor = true;
+};
+
+Layout table_layout(const Table& table) {
+    Layout layout;
+    const TableDesc& desc = table.tableDesc();
+    if (table.nrow() == 0 || !desc.isColumn("TIME")) {
+        layout.nBls = std::max(table.nrow(), (rownr_t)1);
+        return layout;
+    }
+    Vector<Double> times = ScalarColumn<Double>(table, "TIME").getColumn();
+    std::set<Double> uniqueTimes(times.begin(), times.end());
+    layout.nTimes = uniqueTimes.size();
+    for (rownr_t i = 1; i < times.size(); i++) {
+        if (times[i] < times[i - 1]) layout.timeMajor = false;
+    }
+    if (desc.isColumn("ANTENNA1") && desc.isColumn("ANTENNA2")) {
+        Vector<Int> ant1 = ScalarColumn<Int>(table, "ANTENNA1").getColumn();
+        Vector<Int> ant2 = ScalarColumn<Int>(table, "ANTENNA2").getColumn();
+        std::set<std::pair<Int, Int>> baselines;
+        for (rownr_t i = 0; i < ant1.size(); i++) {
+            baselines.insert(std::make_pair(ant1[i], ant2[i]));
+        }
+        layout.nBls = baselines.size();
+    } else {
+        layout.nBls = table.nrow() / layout.nTimes;
+    }
+    return layout;
+}
+
+// access patterns the advisor knows about
+enum Pattern { PER_TIMESTEP, PER_BASELINE, PER_CHANNEL };
+
+// recommended storage manager, tile shape and cache size for a column
+struct Advice {
+    std::string stMan;
+    IPosition tileShape;
+    long long cacheBytes = 0;
+    std::string note;
+};
+
+// Recommend a layout for an array column with the given cell shape. Tiles
+// hold whole cells over as many rows as fit in TILE_BYTES, except that for
+// per-channel access they are narrow in frequency, and cells too big for a
+// tile are split along the channel axis. The cache must hold every tile that
+// is revisited: the tiles across one cell, times the number of row blocks a
+// group of rows touches when it is strided.
+Advice advise_array(const IPosition& cellShape, double elementBytes, const Layout& layout, Pattern pattern) {
+    Advice advice;
+    advice.stMan = "TiledColumnStMan";
+    IPosition tileCell(cellShape);
+    bool hasChannels = cellShape.size() >= 2;
+    if (pattern == PER_CHANNEL && hasChannels) {
+        tileCell[1] = std::min((long long)cellShape[1], 16LL);
+    }
+    while (tileCell.product() * elementBytes > TILE_BYTES && hasChannels && tileCell[1] > 1) {
+        tileCell[1] = (tileCell[1] + 1) / 2;
+    }
+    double cellBytes = tileCell.product() * elementBytes;
+    rownr_t tileRows = std::max((long long)1, (long long)(TILE_BYTES / cellBytes));
+    tileRows = std::min(tileRows, layout.nTimes * layout.nBls);
+    advice.tileShape = tileCell;
+    advice.tileShape.append(IPosition(1, tileRows));
+    long long tileBytes = std::ceil(cellBytes * tileRows);
+    long long tilesAcross = 1;
+    for (size_t i = 0; i < cellShape.size(); i++) {
+        tilesAcross *= (cellShape[i] + tileCell[i] - 1) / tileCell[i];
+    }
+    if (pattern == PER_CHANNEL) {
+        // a channel range only touches the tiles it overlaps
+        tilesAcross = hasChannels ? 2 : tilesAcross;
+    }
+    long long strided = 1;
+    if (pattern == PER_BASELINE && layout.timeMajor) strided = layout.nTimes;
+    if (pattern == PER_TIMESTEP && !layout.timeMajor) strided = layout.nBls;
+    advice.cacheBytes = tilesAcross * strided * tileBytes;
+    if (advice.cacheBytes > CACHE_BUDGET) {
+        advice.note = "cache too large, consider reordering the rows";
+    }
+    return advice;
+}
+
+// Recommend IncrementalStMan for scalar columns whose value changes on
+// fewer than 1 in 8 rows on average, StandardStMan otherwise.
+Advice advise_scalar(const Table& table, const ColumnDesc& colDesc) {
+    Advice advice;
+    advice.stMan = "StandardStMan";
+    switch (colDesc.dataType()) {
+        case TpShort: case TpUShort: case TpInt: case TpUInt: case TpInt64: case TpFloat: case TpDouble:
+            break;
+        default:
+            return advice;
+    }
+    TableColumn col(table, colDesc.name());
+    rownr_t nChanges = 0;
+    for (rownr_t i = 1; i < table.nrow(); i++) {
+        if (col.asdouble(i) != col.asdouble(i - 1)) nChanges++;
+    }
+    if (nChanges * 8 < table.nrow()) {
+        advice.stMan = "IncrementalStMan";
+    }
+    return advice;
+}
+
+// drop all files of a table from the page cache
+void evict_table(const std::string& tableName) {
+    for (auto& file : file_sizes(tableName)) {
+        evict_file(tableName + "/" + file.first);
+    }
+}
+
+// read an array column of a time-major table in an access pattern
+template <typename T>
+void read_pattern(const Table& table, const String& column, const Layout& layout, Pattern pattern, int nChannels) {
+    ArrayColumn<T> col(table, column);
+    Array<T> buffer;
+    switch (pattern) {
+        case PER_TIMESTEP:
+            for (rownr_t t = 0; t < layout.nTimes; t++) {
+                col.getColumnRange(Slicer(IPosition(1, t * layout.nBls), IPosition(1, layout.nBls)), buffer, True);
+            }
+            break;
+        case PER_BASELINE:
+            for (rownr_t bl = 0; bl < layout.nBls; bl++) {
+                col.getColumnCells(RefRows(bl, bl + (layout.nTimes - 1) * layout.nBls, layout.nBls), buffer, True);
+            }
+            break;
+        case PER_CHANNEL: {
+            IPosition cellShape = col.shape(0);
+            IPosition length(cellShape);
+            if (cellShape.size() >= 2) length[1] = std::min((long long)cellShape[1], (long long)nChannels);
+            Slicer cellSlicer(IPosition(cellShape.size(), 0), length);
+            for (rownr_t t = 0; t < layout.nTimes; t++) {
+                col.getColumnRange(Slicer(IPosition(1, t * layout.nBls), IPosition(1, layout.nBls)), cellSlicer, buffer, True);
+            }
+            break;
+        }
+    }
+}
+
+// Copy the array columns of the first timesteps into a scratch table with
+// StandardStMan and one with the recommended tiled layout, and time reading
+// each in the access pattern from a cold page cache.
+void confirm_advice(const Table& table, const Layout& layout, Pattern pattern, rownr_t confirmRows,
+        const std::map<std::string, Advice>& advice) {
+    if (!layout.timeMajor) {
+        std::cout << "confirmation is only supported for time-major tables" << std::endl;
+        return;
+    }
+    Layout subsetLayout = layout;
+    subsetLayout.nTimes = std::min(layout.nTimes, std::max((rownr_t)1, confirmRows / layout.nBls));
+    Vector<rownr_t> rownrs(subsetLayout.nTimes * layout.nBls);
+    indgen(rownrs);
+    Table subset = table(rownrs);
+
+    const TableDesc& sourceDesc = table.tableDesc();
+    TableDesc td("tAdviseDesc", "1", TableDesc::Scratch);
+    for (auto& column : advice) {
+        if (column.second.tileShape.empty()) continue;
+        ColumnDesc colDesc(sourceDesc.columnDesc(column.first));
+        colDesc.setShape(TableColumn(table, column.first).shape(0));
+        colDesc.dataManagerType() = "StandardStMan";
+        colDesc.dataManagerGroup() = "StandardStMan";
+        td.addColumn(colDesc);
+    }
+    std::cout << std::endl << "Confirming on " << subset.nrow() << " rows:" << std::endl;
+    printf("%-20s %14s %14s\n", "Name", "standard(s)", "advised(s)");
+    const char* layoutNames[] = {"/tmp/tableinfo.standard", "/tmp/tableinfo.advised"};
+    std::map<std::string, double> seconds[2];
+    for (int advised = 0; advised < 2; advised++) {
+        {
+            SetupNewTable newtab(layoutNames[advised], td, Table::New);
+            for (uInt i = 0; advised && i < td.ncolumn(); i++) {
+                const String& name = td.columnDesc(i).name();
+                const Advice& columnAdvice = advice.at(name);
+                newtab.bindColumn(name, TiledColumnStMan("Tiled" + name, columnAdvice.tileShape, columnAdvice.cacheBytes));
+            }
+            Table scratch(newtab, subset.nrow());
+            for (uInt i = 0; i < td.ncolumn(); i++) {
+                TableCopy::copyColumnData(subset, td.columnDesc(i).name(), scratch, td.columnDesc(i).name());
+            }
+        }
+        evict_table(layoutNames[advised]);
+        Table scratch(layoutNames[advised]);
+        for (uInt i = 0; i < td.ncolumn(); i++) {
+            const ColumnDesc& colDesc = td.columnDesc(i);
+            int nChannels = 16;
+            auto start = std::chrono::steady_clock::now();
+            switch (colDesc.dataType()) {
+                case TpBool: read_pattern<Bool>(scratch, colDesc.name(), subsetLayout, pattern, nChannels); break;
+                case TpFloat: read_pattern<Float>(scratch, colDesc.name(), subsetLayout, pattern, nChannels); break;
+                case TpDouble: read_pattern<Double>(scratch, colDesc.name(), subsetLayout, pattern, nChannels); break;
+                case TpComplex: read_pattern<Complex>(scratch, colDesc.name(), subsetLayout, pattern, nChannels); break;
+                case TpDComplex: read_pattern<DComplex>(scratch, colDesc.name(), subsetLayout, pattern, nChannels); break;
+                default: break;
+            }
+            seconds[advised][colDesc.name()] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+    for (uInt i = 0; i < td.ncolumn(); i++) {
+        const String& name = td.columnDesc(i).name();
+        printf("%-20s %14.3f %14.3f\n", name.c_str(), seconds[0][name], seconds[1][name]);
+    }
+    Table::deleteTable(layoutNames[0]);
+    Table::deleteTable(layoutNames[1]);
+}
+
+// print a storage manager, tile shape and cache size for each column for the
+// access pattern, optionally confirming them with a quick read benchmark.
+void print_advice(const Table& table, Pattern pattern, rownr_t confirmRows) {
+    const char* patternNames[] = {"per-timestep", "per-baseline", "per-channel"};
+    Layout layout = table_layout(table);
+    std::cout << std::endl << "Layout advice for " << patternNames[pattern] << " access (" << layout.nTimes \
+        << " timesteps, " << layout.nBls << " baselines, " << (layout.timeMajor ? "time-major" : "not time-major") \
+        << "):" << std::endl;
+    printf("%-20s %-20s %-20s %14s %s\n", "Name", "StMan", "tile shape", "cache bytes", "note");
+    const TableDesc& desc = table.tableDesc();
+    std::map<std::string, Advice> advice;
+    for (uInt i = 0; i < desc.ncolumn(); i++) {
+        const ColumnDesc& colDesc = desc.columnDesc(i);
+        String name = colDesc.name();
+        Advice columnAdvice;
+        if (colDesc.isScalar()) {
+            columnAdvice = advise_scalar(table, colDesc);
+        } else {
+            TableColumn col(table, name);
+            if (table.nrow() == 0 || !col.isDefined(0)) continue;
+            columnAdvice = advise_array(col.shape(0), element_bytes(colDesc.dataType()), layout, pattern);
+        }
+        std::ostringstream tileShape;
+        if (!columnAdvice.tileShape.empty()) tileShape << columnAdvice.tileShape;
+        printf("%-20s %-20s %-20s %14lld %s\n", name.c_str(), columnAdvice.stMan.c_str(), tileShape.str().c_str(),
+            columnAdvice.cacheBytes, columnAdvice.note.c_str());
+        advice[name] = columnAdvice;
+    }
+    if (confirmRows > 0) {
+        confirm_advice(table, layout, pattern, confirmRows, advice);
+    }
+}
+
+void usage(char const *argv[]) {
+    std::cout << "Usage: " << argv[0] << " [--scan [--cold] [--chunk <rows>]] [--advise <pattern> [--confirm <rows>]] <table>\n" \
+        << "  --scan: read each column in full and report its read throughput\n" \
+        << "  --cold: evict each column's files from the page cache before scanning it\n" \
+        << "  --chunk <rows>: rows per getColumnRange when scanning (default: 10000)\n" \
+        << "  --advise <pattern>: recommend a storage manager, tile shape and cache size for each column\n" \
+        << "    patterns: timestep, baseline, channel\n" \
+        << "  --confirm <rows>: check the advice by reading about this many rows with each layout\n";
+}
+
 int main(int argc, char const *argv[]) {
-    const char* filename = argv[1];
+    const char* filename = NULL;
+    bool scan = false;
+    bool cold = false;
+    rownr_t chunkRows = 10000;
+    bool advise = false;
+    Pattern pattern = PER_TIMESTEP;
+    rownr_t confirmRows = 0;
+    for (int argi = 1; argi < argc; argi++) {
+        std::string arg(argv[argi]);
+        if (arg == "-h" || arg == "--help") {
+            usage(argv);
+            return 0;
+        } else if (arg == "--scan") {
+            scan = true;
+        } else if (arg == "--cold") {
+            cold = true;
+        } else if (arg == "--chunk" && argi + 1 < argc) {
+            chunkRows = std::max(1, atoi(argv[++argi]));
+        } else if (arg == "--advise" && argi + 1 < argc) {
+            advise = true;
+            std::string patternName(argv[++argi]);
+            if (patternName == "timestep") {
+                pattern = PER_TIMESTEP;
+            } else if (patternName == "baseline") {
+                pattern = PER_BASELINE;
+            } else if (patternName == "channel") {
+                pattern = PER_CHANNEL;
+            } else {
+                usage(argv);
+                throw std::runtime_error("unknown access pattern: " + patternName);
+            }
+        } else if (arg == "--confirm" && argi + 1 < argc) {
+            confirmRows = std::max(1, atoi(argv[++argi]));
+        } else if (arg[0] != '-' && filename == NULL) {
+            filename = argv[argi];
+        } else {
+            usage(argv);
+            throw std::runtime_error("unknown option: " + arg);
+        }
+    }
+    if (filename == NULL) {
+        usage(argv);
+        return 1;
+    }
+    if (confirmRows > 0 && !advise) {
+        usage(argv);
+        throw std::runtime_error("--confirm only applies with --advise");
+    }
     Table table(filename);
     std::cout << "Number of rows: " << table.nrow() << endl;
     TableDesc desc = table.tableDesc();
@@ -33,4 +660,11 @@ int main(int argc, char const *argv[]) {
         printf("%-*s %1c %1c %1c %1c %1c %1c\n", max_colname_len, desc.columnNames()[i].c_str(),
             fixed, scalar, array, table, direct, undefined);
     }
-}
\ No newline at end of file
+    print_data_managers(table);
+    if (scan) {
+        print_scan(table, chunkRows, cold);
+    }
+    if (advise) {
+        print_advice(table, pattern, confirmRows);
+    }
+}